@@ -0,0 +1,49 @@
+#ifndef _POLYGAMMA_BENCH_BENCHMARK_HPP__
+#define _POLYGAMMA_BENCH_BENCHMARK_HPP__
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace pg
+{
+
+/**
+ * Runs f in rounds of doubling repetitions until a round takes at least
+ * minSeconds, then keeps the fastest of rounds such rounds, which filters out
+ * interruptions by the system.
+ * @brief Seconds taken by one call of f.
+ */
+template <typename F>
+double benchmark(F f, double minSeconds = 0.05, unsigned rounds = 5);
+
+
+// Implementations
+
+template <typename F>
+double benchmark(F f, double minSeconds, unsigned rounds)
+{
+	typedef std::chrono::steady_clock Clock;
+	std::size_t repetitions = 1;
+	double best = std::numeric_limits<double>::infinity();
+	for (unsigned r = 0; r < rounds; )
+	{
+		Clock::time_point const begin = Clock::now();
+		for (std::size_t i = 0; i < repetitions; ++i)
+			f();
+		double const elapsed =
+		  std::chrono::duration<double>(Clock::now() - begin).count();
+		if (elapsed < minSeconds)
+		{
+			repetitions *= 2;
+			continue;
+		}
+		best = std::min(best, elapsed / repetitions);
+		++r;
+	}
+	return best;
+}
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_BENCH_BENCHMARK_HPP__
@@ -0,0 +1,100 @@
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../src/math/FFTPlan.hpp"
+#include "benchmark.hpp"
+
+namespace pg
+{
+
+/*
+ * The recursive Cooley-Tukey transform which FFTPlan replaced, kept for
+ * comparison. Only powers of 2 are supported.
+ */
+void dftCT(complex* const spectrum, complex const* const signal,
+           std::size_t length, std::size_t modulo, real sign)
+{
+	if (length == 1)
+	{
+		spectrum[0] = signal[0];
+	}
+	else
+	{
+		complex w(std::cos(2 * M_PI / length), sign * std::sin(2 * M_PI / length));
+		std::size_t mid = length / 2;
+		dftCT(spectrum, signal, mid, 2 * modulo, sign);
+		dftCT(spectrum + mid, signal + modulo, mid, 2 * modulo, sign);
+		for (std::size_t i = 0; i < mid; ++i)
+		{
+			complex temp = spectrum[i];
+			complex transformed = std::pow(w, i) * spectrum[i + mid];
+			spectrum[i] = temp + transformed;
+			spectrum[i + mid] = temp - transformed;
+		}
+	}
+}
+
+/*
+ * Largest error relative to the largest bin, against a direct transform in
+ * long double.
+ */
+real error(complex const* const spectrum, complex const* const signal,
+           std::size_t length)
+{
+	typedef std::complex<long double> Long;
+	long double err = 0, peak = 0;
+	for (std::size_t k = 0; k < length; ++k)
+	{
+		Long sum = 0;
+		for (std::size_t j = 0; j < length; ++j)
+		{
+			long double const angle = -2 * M_PIl * ((j * k) % length) / length;
+			sum += Long(signal[j]) * Long(std::cos(angle), std::sin(angle));
+		}
+		err = std::max(err, std::abs(Long(spectrum[k]) - sum));
+		peak = std::max(peak, std::abs(sum));
+	}
+	return (real) (err / peak);
+}
+
+} // namespace pg
+
+/*
+ * Times the forward transform of random complex signals of power of 2 lengths
+ * by the old recursive dftCT and by FFTPlan, and compares their accuracy up to
+ * 4096 points.
+ */
+int main()
+{
+	std::mt19937 generator(1);
+	std::uniform_real_distribution<pg::real> distribution(-1.0, 1.0);
+	std::printf("%8s %12s %12s %9s %10s %10s\n", "length", "dftCT (us)",
+	            "FFTPlan (us)", "speed-up", "dftCT err", "plan err");
+	for (std::size_t length = 256; length <= 65536; length *= 2)
+	{
+		std::vector<pg::complex> signal(length), spectrum(length);
+		for (auto& x: signal)
+			x = pg::complex(distribution(generator), distribution(generator));
+		auto const& plan = pg::FFTPlan<pg::real>::get(
+		                     length, pg::FFTPlan<pg::real>::Forward);
+
+		double const old = pg::benchmark([&]
+		{
+			pg::dftCT(spectrum.data(), signal.data(), length, 1, -1.0);
+		});
+		pg::real const oldError = length <= 4096 ?
+		  pg::error(spectrum.data(), signal.data(), length) : NAN;
+		double const planned = pg::benchmark([&]
+		{
+			plan.execute(spectrum.data(), signal.data());
+		});
+		pg::real const planError = length <= 4096 ?
+		  pg::error(spectrum.data(), signal.data(), length) : NAN;
+
+		std::printf("%8zu %12.2f %12.2f %8.1fx %10.2g %10.2g\n", length,
+		            old * 1e6, planned * 1e6, old / planned, oldError, planError);
+	}
+	return 0;
+}
@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../src/math/FFTPlan.hpp"
+#include "benchmark.hpp"
+
+/*
+ * Times the transform of 65536 points of random data cut into frames of
+ * power of 2 lengths, frame by frame with executeSplit() and all at once with
+ * executeBatch(), which interleaves frames up to BATCH_MAX points. Each run
+ * transforms a fresh copy of the data, lest repeated transforms overflow it,
+ * and the time of the copy is subtracted.
+ */
+int main()
+{
+	typedef pg::FFTPlan<pg::real> Plan;
+	std::size_t const total = 65536;
+	std::mt19937 generator(1);
+	std::uniform_real_distribution<pg::real> distribution(-1.0, 1.0);
+	std::vector<pg::real> sourceRe(total), sourceIm(total);
+	for (std::size_t i = 0; i < total; ++i)
+	{
+		sourceRe[i] = distribution(generator);
+		sourceIm[i] = distribution(generator);
+	}
+	std::vector<pg::real> re(total), im(total);
+	auto const copy = [&]
+	{
+		std::copy(sourceRe.begin(), sourceRe.end(), re.begin());
+		std::copy(sourceIm.begin(), sourceIm.end(), im.begin());
+	};
+	double const copied = pg::benchmark(copy);
+
+	std::printf("BATCH_MAX = %zu\n", Plan::BATCH_MAX);
+	std::printf("%8s %8s %15s %12s %9s\n", "length", "frames",
+	            "per frame (us)", "batch (us)", "speed-up");
+	for (std::size_t length = 2; length <= 1024; length *= 2)
+	{
+		std::size_t const nFrames = total / length;
+		auto const& plan = Plan::get(length, Plan::Forward);
+
+		double const single = pg::benchmark([&]
+		{
+			copy();
+			for (std::size_t f = 0; f < nFrames; ++f)
+				plan.executeSplit(re.data() + f * length, im.data() + f * length);
+		}) - copied;
+		double const batch = pg::benchmark([&]
+		{
+			copy();
+			plan.executeBatch(re.data(), im.data(), nFrames);
+		}) - copied;
+
+		std::printf("%8zu %8zu %15.2f %12.2f %8.2fx\n", length, nFrames,
+		            single * 1e6, batch * 1e6, single / batch);
+	}
+	return 0;
+}
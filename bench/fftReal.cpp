@@ -0,0 +1,41 @@
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../src/math/FFTPlan.hpp"
+#include "benchmark.hpp"
+
+/*
+ * Times the forward transform of random real signals by the complex transform
+ * of the signal and by executeReal(), which transforms half the length.
+ */
+int main()
+{
+	typedef pg::FFTPlan<pg::real> Plan;
+	std::mt19937 generator(1);
+	std::uniform_real_distribution<pg::real> distribution(-1.0, 1.0);
+	std::printf("%8s %13s %10s %9s\n", "length", "complex (us)", "real (us)",
+	            "speed-up");
+	for (std::size_t length: {256, 1000, 1024, 4096, 4800, 16384, 65536})
+	{
+		std::vector<pg::real> signal(length);
+		for (auto& x: signal)
+			x = distribution(generator);
+		std::vector<pg::complex> input(signal.begin(), signal.end());
+		std::vector<pg::complex> spectrum(length);
+		auto const& plan = Plan::get(length, Plan::Forward);
+
+		double const full = pg::benchmark([&]
+		{
+			plan.execute(spectrum.data(), input.data());
+		});
+		double const half = pg::benchmark([&]
+		{
+			plan.executeReal(spectrum.data(), signal.data());
+		});
+
+		std::printf("%8zu %13.2f %10.2f %8.2fx\n", length, full * 1e6,
+		            half * 1e6, full / half);
+	}
+	return 0;
+}
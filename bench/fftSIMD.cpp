@@ -0,0 +1,60 @@
+#include <complex>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../src/math/FFTPlan.hpp"
+#include "benchmark.hpp"
+
+namespace pg
+{
+
+/*
+ * Prints the time of a forward transform of every length under each
+ * instruction set up to the best one supported.
+ */
+template <typename T>
+void benchmarkSIMD(char const* const name, SIMD const best)
+{
+	static char const* const names[] = {"scalar", "SSE2", "AVX2", "AVX-512"};
+	std::mt19937 generator(1);
+	std::uniform_real_distribution<T> distribution(-1, 1);
+
+	std::printf("%-6s %6s", name, "length");
+	for (int s = SIMDScalar; s <= best; ++s)
+		std::printf(" %12s", names[s]);
+	std::printf(" (us)\n");
+	for (std::size_t length: {256, 1024, 4096, 16384, 65536})
+	{
+		std::vector<std::complex<T>> signal(length), spectrum(length);
+		for (auto& x: signal)
+			x = std::complex<T>(distribution(generator), distribution(generator));
+		auto const& plan = FFTPlan<T>::get(length, FFTPlan<T>::Forward);
+
+		std::printf("%-6s %6zu", "", length);
+		for (int s = SIMDScalar; s <= best; ++s)
+		{
+			simdLimit((SIMD) s);
+			std::printf(" %12.2f", 1e6 * benchmark([&]
+			{
+				plan.execute(spectrum.data(), signal.data());
+			}));
+		}
+		std::printf("\n");
+	}
+	simdLimit(best);
+}
+
+} // namespace pg
+
+/*
+ * Times the transforms of random complex signals on the scalar reference and
+ * on the vector kernels of each instruction set, which simdLimit() selects.
+ */
+int main()
+{
+	pg::SIMD const best = pg::simdSupported();
+	pg::benchmarkSIMD<double>("double", best);
+	pg::benchmarkSIMD<float>("float", best);
+	return 0;
+}
@@ -12,7 +12,8 @@ namespace pg
 Configuration::Configuration():
 	cacheDirPlayback("."),
 	uiBG(0xFFFFFFFF), uiTerminalBG(0xFFFFFFFF), uiScriptLevelMin(Script::UI),
-	uiWaveformBG(0xFF000000), uiWaveformCore(0xFFFFFFFF), uiWaveformEdge(0xFFFFAA88)
+	uiWaveformBG(0xFF000000), uiWaveformCore(0xFFFFFFFF), uiWaveformEdge(0xFFFFAA88),
+	uiWaveformPlayhead(0xFF0080FF)
 {
 }
 
@@ -45,6 +46,7 @@ bool Configuration::loadFile()
 		uiWaveformBG = treeUI->get("WaveformBG", uiWaveformBG);
 		uiWaveformCore = treeUI->get("WaveformCore", uiWaveformCore);
 		uiWaveformEdge = treeUI->get("WaveformEdge", uiWaveformEdge);
+		uiWaveformPlayhead = treeUI->get("WaveformPlayhead", uiWaveformPlayhead);
 	}
 
 	return true;
@@ -64,6 +66,7 @@ void Configuration::saveFile()
 	treeUI.put("WaveformBG", uiWaveformBG);
 	treeUI.put("WaveformCore", uiWaveformCore);
 	treeUI.put("WaveformEdge", uiWaveformEdge);
+	treeUI.put("WaveformPlayhead", uiWaveformPlayhead);
 	tree.put_child("ui", treeUI);
 
 	boost::property_tree::xml_writer_settings<std::string> settings('\t', 1);
@@ -54,6 +54,7 @@ public:
 	Colour32 uiWaveformBG;
 	Colour32 uiWaveformCore;
 	Colour32 uiWaveformEdge;
+	Colour32 uiWaveformPlayhead;
 
 private:
 	boost::signals2::signal<void ()> signalChanged;
@@ -151,6 +151,21 @@ void Kernel::fromFileImport(std::string fileName) throw(PythonException)
 	if (buffer) pushBuffer(buffer);
 	else throw PythonException{error, PythonException::IOError};
 }
+void Kernel::bounceSingular(std::size_t index,
+                            std::size_t sampleRate) throw(PythonException)
+{
+	if (buffers.size() <= index)
+		throw PythonException{"Buffer index out of range", PythonException::ValueError};
+	if (buffers[index]->getType() != Buffer::Singular)
+		throw PythonException{"Buffer is not a BufferSingular",
+		                      PythonException::ValueError};
+
+	std::string error;
+	BufferSingular* buffer =
+	  static_cast<BufferSingular*>(buffers[index])->bounce(sampleRate, &error);
+	if (buffer) pushBuffer(buffer);
+	else throw PythonException{error, PythonException::RuntimeError};
+}
 
 void Kernel::pushBuffer(Buffer* buffer) noexcept
 {
@@ -128,6 +128,13 @@ public:
 	 *  Polygamma project files.
 	 */
 	void fromFileImport(std::string fileName) throw(PythonException);
+	/**
+	 * Exposed to Python
+	 * @brief Renders the playback path of a BufferSingular offline into a new
+	 *  buffer. See BufferSingular::bounce.
+	 */
+	void bounceSingular(std::size_t index,
+	                    std::size_t sampleRate) throw(PythonException);
 
 
 private:
@@ -11,6 +11,7 @@ extern "C"
 #include "Kernel.hpp"
 #include "Buffer.hpp"
 #include "text.hpp"
+#include "../singular/FingerprintIndex.hpp"
 #include "../singular/audio.hpp"
 #include "../singular/BufferSingular.hpp"
 
@@ -21,6 +22,25 @@ namespace wrap
 // Within this namespace is the only place where function names can begin with
 // capital letters.
 
+void envelopeInsert(pg::Envelope& envelope, std::size_t position,
+                    pg::real value, std::string curve)
+{
+	pg::CurveType type;
+	if (!pg::curveParse(&type, curve))
+		throw pg::PythonException{"Unknown curve: " + curve,
+		                          pg::PythonException::ValueError};
+	envelope.insert(position, value, type);
+}
+
+boost::python::list fingerprintQuery(pg::FingerprintIndex& index,
+                                     pg::BufferSingular const* buffer)
+{
+	boost::python::list result;
+	for (auto const& match: index.query(buffer))
+		result.append(match);
+	return result;
+}
+
 void exceptionTranslator(pg::PythonException const& exc)
 {
 	switch (exc.type)
@@ -75,9 +95,14 @@ BOOST_PYTHON_MODULE(pg)
 	class_<std::vector<pg::Vector<pg::real>>>("stdvector_Vector_real")
 	.def(vector_indexing_suite<std::vector<pg::Vector<pg::real>>>());
 
+	class_<std::vector<pg::real>>("stdvector_real")
+	.def(vector_indexing_suite<std::vector<pg::real>>());
+
 	class_<pg::IntervalIndex>("IntervalIndex", init<std::size_t, std::size_t>())
 	.def_readwrite("begin", &pg::IntervalIndex::begin)
 	.def_readwrite("end", &pg::IntervalIndex::end);
+	class_<std::vector<pg::IntervalIndex>>("stdvector_IntervalIndex")
+	.def(vector_indexing_suite<std::vector<pg::IntervalIndex>>());
 
 	// Buffers
 
@@ -117,16 +142,155 @@ BOOST_PYTHON_MODULE(pg)
 	     &pg::BufferSingular::clearSelect)
 	.def("clearSelect", (void (pg::BufferSingular::*)(std::size_t))
 	     &pg::BufferSingular::clearSelect)
-	.def("getSelection", &pg::BufferSingular::getSelection);
+	.def("getSelection", &pg::BufferSingular::getSelection)
+	.add_property("playhead", &pg::BufferSingular::playhead)
+	.def("bounceToFile", (void (pg::BufferSingular::*)(std::string, std::size_t))
+	     &pg::BufferSingular::bounceToFile)
+	.add_property("automation", make_function(&pg::BufferSingular::getAutomation,
+	              return_internal_reference<>()))
+	.add_property("inserts", make_function(&pg::BufferSingular::getInserts,
+	              return_internal_reference<>()))
+	.add_property("stretcher", make_function(&pg::BufferSingular::getStretcher,
+	              return_internal_reference<>()));
+
+	// InsertChain
+	class_<pg::InsertChain::Load>("InsertLoad", no_init)
+	.def_readonly("last", &pg::InsertChain::Load::last)
+	.def_readonly("peak", &pg::InsertChain::Load::peak)
+	.def_readonly("overruns", &pg::InsertChain::Load::overruns);
+	class_<pg::InsertChain, boost::noncopyable>("InsertChain", no_init)
+	.def("clear", &pg::InsertChain::clear)
+	.def("setGain", &pg::InsertChain::setGain)
+	.def("setEQ", &pg::InsertChain::setEQ)
+	.def("setLimiter", &pg::InsertChain::setLimiter)
+	.def("load", &pg::InsertChain::load)
+	.add_property("budget", &pg::InsertChain::getBudget,
+	              &pg::InsertChain::setBudget);
+
+	// Automation
+	class_<pg::Envelope>("Envelope", init<optional<pg::real>>())
+	.def("__len__", &pg::Envelope::size)
+	.def("insert", &pg::wrap::envelopeInsert,
+	     (arg("position"), arg("value"), arg("curve") = "linear"))
+	.def("erase", &pg::Envelope::erase)
+	.def("clear", &pg::Envelope::clear)
+	.def("valueAt", &pg::Envelope::valueAt);
+	class_<pg::Automation, boost::noncopyable>("Automation", no_init)
+	.def("setVolume", &pg::Automation::setVolume)
+	.def("setPan", &pg::Automation::setPan)
+	.def("clear", &pg::Automation::clear);
+
+	// Stretcher
+	enum_<pg::Stretcher::Mode>("StretchMode")
+	.value("Normal", pg::Stretcher::Normal)
+	.value("Varispeed", pg::Stretcher::Varispeed)
+	.value("TimeStretch", pg::Stretcher::TimeStretch);
+	class_<pg::Stretcher, boost::noncopyable>("Stretcher", no_init)
+	.add_property("mode", &pg::Stretcher::getMode, &pg::Stretcher::setMode)
+	.add_property("rate", &pg::Stretcher::getRate, &pg::Stretcher::setRate);
 
 	// BufferSingular associated functions
 	def("silence", +[](pg::BufferSingular* b){ pg::silence(b); });
+	def("gain", &pg::gain, (arg("buffer"), arg("gain")));
+	def("invert", &pg::invert);
+	def("removeDC", &pg::removeDC);
+	def("fadeIn", &pg::fadeIn, (arg("buffer"), arg("shape") = "linear"));
+	def("fadeOut", &pg::fadeOut, (arg("buffer"), arg("shape") = "linear"));
+	def("applyEnvelope", &pg::applyEnvelope, (arg("buffer"), arg("envelope")));
+	def("crossfade", &pg::crossfade,
+	    (arg("buffer"), arg("source"), arg("offset") = 0, arg("shape") = "sine"));
+	def("normalize", &pg::normalize,
+	    (arg("buffer"), arg("target"), arg("mode") = "peak"));
+	def("filter", &pg::filter,
+	    (arg("buffer"), arg("shape"), arg("frequency"), arg("q") = M_SQRT1_2,
+	     arg("gain") = 0.0, arg("order") = 2));
+	def("compress", &pg::compress,
+	    (arg("buffer"), arg("threshold"), arg("ratio") = 4.0,
+	     arg("attack") = 0.01, arg("release") = 0.1, arg("knee") = 6.0,
+	     arg("lookahead") = 0.0, arg("makeup") = 0.0, arg("detector") = "peak"));
+	def("limit", &pg::limit,
+	    (arg("buffer"), arg("ceiling") = -1.0, arg("release") = 0.05,
+	     arg("lookahead") = 0.005));
+	class_<pg::Analysis>("Analysis", no_init)
+	.def_readonly("peak", &pg::Analysis::peak)
+	.def_readonly("truePeak", &pg::Analysis::truePeak)
+	.def_readonly("rms", &pg::Analysis::rms)
+	.def_readonly("integrated", &pg::Analysis::integrated)
+	.def_readonly("momentaryMax", &pg::Analysis::momentaryMax)
+	.def_readonly("shortTermMax", &pg::Analysis::shortTermMax)
+	.def_readonly("blockDuration", &pg::Analysis::blockDuration)
+	.def_readonly("blockPeak", &pg::Analysis::blockPeak)
+	.def_readonly("blockRMS", &pg::Analysis::blockRMS)
+	.def_readonly("momentary", &pg::Analysis::momentary)
+	.def_readonly("shortTerm", &pg::Analysis::shortTerm);
+	def("analyze", +[](pg::BufferSingular* b, pg::IntervalIndex selection)
+	{
+		return pg::analyze(b, selection);
+	}, (arg("buffer"), arg("selection")));
+	def("analyze", +[](pg::BufferSingular* b)
+	{
+		return pg::analyze(b, pg::IntervalIndex(0, b->duration()));
+	}, (arg("buffer")));
+	class_<pg::Alignment>("Alignment", no_init)
+	.def_readonly("offset", &pg::Alignment::offset)
+	.def_readonly("confidence", &pg::Alignment::confidence);
+	def("align", +[](pg::BufferSingular const* a, pg::BufferSingular const* b,
+	                 std::size_t maxLag)
+	{
+		return pg::align(a, b, maxLag);
+	}, (arg("a"), arg("b"), arg("maxLag")));
+	class_<pg::NoiseProfile>("NoiseProfile", no_init)
+	.def_readonly("sampleRate", &pg::NoiseProfile::sampleRate)
+	.def_readonly("nFrames", &pg::NoiseProfile::nFrames);
+	def("noiseProfile", +[](pg::BufferSingular* b)
+	{
+		return pg::noiseProfile(b);
+	}, (arg("buffer")));
+	def("denoise", +[](pg::BufferSingular* b, pg::NoiseProfile const& profile,
+	                   pg::real threshold, pg::real reduction,
+	                   std::size_t smoothBins, std::size_t smoothFrames)
+	{
+		pg::denoise(b, profile, threshold, reduction, smoothBins, smoothFrames);
+	}, (arg("buffer"), arg("profile"), arg("threshold")=6.0,
+	    arg("reduction")=18.0, arg("smoothBins")=2, arg("smoothFrames")=2));
+	def("detectSilence", +[](pg::BufferSingular* b, pg::real threshold,
+	                         pg::real minDuration)
+	{
+		return pg::detectSilence(b, threshold, minDuration);
+	}, (arg("buffer"), arg("threshold")=-60.0, arg("minDuration")=0.5));
+	def("detectOnsets", +[](pg::BufferSingular* b, pg::real threshold,
+	                        pg::real minInterval)
+	{
+		return pg::detectOnsets(b, threshold, minInterval);
+	}, (arg("buffer"), arg("threshold")=1.0, arg("minInterval")=0.05));
+	class_<pg::Pitch>("Pitch", no_init)
+	.def_readonly("hop", &pg::Pitch::hop)
+	.def_readonly("frequencies", &pg::Pitch::frequencies)
+	.def_readonly("voiced", &pg::Pitch::voiced);
+	def("detectPitch", +[](pg::BufferSingular* b, pg::real minFrequency,
+	                       pg::real maxFrequency, pg::real threshold)
+	{
+		return pg::detectPitch(b, minFrequency, maxFrequency, threshold);
+	}, (arg("buffer"), arg("minFrequency")=50.0, arg("maxFrequency")=1000.0,
+	    arg("threshold")=0.15));
+	class_<pg::FingerprintIndex::Match>("FingerprintMatch", no_init)
+	.def_readonly("name", &pg::FingerprintIndex::Match::name)
+	.def_readonly("offset", &pg::FingerprintIndex::Match::offset)
+	.def_readonly("score", &pg::FingerprintIndex::Match::score);
+	class_<pg::FingerprintIndex, boost::noncopyable>("FingerprintIndex",
+	    init<>())
+	.def(init<std::string>())
+	.def("__len__", &pg::FingerprintIndex::nTracks)
+	.def("add", &pg::FingerprintIndex::add, (arg("buffer"), arg("name") = ""))
+	.def("save", &pg::FingerprintIndex::save)
+	.def("query", &pg::wrap::fingerprintQuery);
 
 	class_<pg::Kernel, boost::noncopyable>("Kernel", no_init)
 	.def_readonly("buffers", &pg::Kernel::getBuffers)
 	.def("fromFileImport", &pg::Kernel::fromFileImport)
 	.def("eraseBuffer", &pg::Kernel::eraseBuffer)
-	.def("createSingular", &pg::Kernel::createSingular);
+	.def("createSingular", &pg::Kernel::createSingular)
+	.def("bounceSingular", &pg::Kernel::bounceSingular);
 
 	initialised = true;
 }
@@ -0,0 +1,131 @@
+#include "BiquadBank.hpp"
+
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace pg
+{
+
+// Implementations
+
+constexpr std::size_t BiquadBank::BLOCK;
+
+BiquadBank::BiquadBank(std::size_t nChannels, std::vector<biquad> sections):
+	nChannels(nChannels), sections(std::move(sections)),
+	state(2 * this->sections.size() * nChannels, 0.0), block(2 * BLOCK)
+{
+}
+
+void BiquadBank::setSections(std::vector<biquad> s)
+{
+	if (s.size() != sections.size())
+		state.assign(2 * s.size() * nChannels, 0.0);
+	sections = std::move(s);
+}
+void BiquadBank::reset() noexcept
+{
+	std::fill(state.begin(), state.end(), 0.0);
+}
+
+void BiquadBank::process(real* const* const channels,
+                         std::size_t length) noexcept
+{
+	std::size_t const stride = 2 * sections.size();
+	std::size_t c = 0;
+	for (; c + 2 <= nChannels; c += 2)
+		processPair(channels[c], channels[c + 1], length, &state[c * stride]);
+	if (c < nChannels)
+		processSingle(channels[c], length, &state[c * stride]);
+}
+
+void BiquadBank::processPair(real* const x0, real* const x1,
+                             std::size_t length, real* const st) noexcept
+{
+	real* const buf = block.data();
+	for (std::size_t begin = 0; begin < length; begin += BLOCK)
+	{
+		std::size_t const n = std::min(length - begin, BLOCK);
+		// Transpose so that every sample of the pair is one aligned load
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			buf[2 * i] = x0[begin + i];
+			buf[2 * i + 1] = x1[begin + i];
+		}
+		for (std::size_t s = 0; s < sections.size(); ++s)
+		{
+			biquad const& f = sections[s];
+			real* const z = st + 4 * s; // s1 of both lanes, then s2
+#ifdef __SSE2__
+			static_assert(sizeof(real) == sizeof(double),
+			              "The SSE2 path assumes double precision");
+			__m128d const b0 = _mm_set1_pd(f.b0);
+			__m128d const b1 = _mm_set1_pd(f.b1);
+			__m128d const b2 = _mm_set1_pd(f.b2);
+			__m128d const a1 = _mm_set1_pd(f.a1);
+			__m128d const a2 = _mm_set1_pd(f.a2);
+			__m128d s1 = _mm_loadu_pd(z);
+			__m128d s2 = _mm_loadu_pd(z + 2);
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				__m128d const x = _mm_load_pd(buf + 2 * i);
+				__m128d const y = _mm_add_pd(_mm_mul_pd(b0, x), s1);
+				s1 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(b1, x), _mm_mul_pd(a1, y)), s2);
+				s2 = _mm_sub_pd(_mm_mul_pd(b2, x), _mm_mul_pd(a2, y));
+				_mm_store_pd(buf + 2 * i, y);
+			}
+			_mm_storeu_pd(z, s1);
+			_mm_storeu_pd(z + 2, s2);
+#else
+			for (std::size_t lane = 0; lane < 2; ++lane)
+			{
+				real s1 = z[lane];
+				real s2 = z[2 + lane];
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					real const x = buf[2 * i + lane];
+					real const y = f.b0 * x + s1;
+					s1 = f.b1 * x - f.a1 * y + s2;
+					s2 = f.b2 * x - f.a2 * y;
+					buf[2 * i + lane] = y;
+				}
+				z[lane] = s1;
+				z[2 + lane] = s2;
+			}
+#endif
+		}
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			x0[begin + i] = buf[2 * i];
+			x1[begin + i] = buf[2 * i + 1];
+		}
+	}
+}
+void BiquadBank::processSingle(real* const x, std::size_t length,
+                               real* const st) noexcept
+{
+	for (std::size_t begin = 0; begin < length; begin += BLOCK)
+	{
+		std::size_t const n = std::min(length - begin, BLOCK);
+		real* const p = x + begin;
+		for (std::size_t s = 0; s < sections.size(); ++s)
+		{
+			biquad const& f = sections[s];
+			real s1 = st[2 * s];
+			real s2 = st[2 * s + 1];
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				real const y = f.b0 * p[i] + s1;
+				s1 = f.b1 * p[i] - f.a1 * y + s2;
+				s2 = f.b2 * p[i] - f.a2 * y;
+				p[i] = y;
+			}
+			st[2 * s] = s1;
+			st[2 * s + 1] = s2;
+		}
+	}
+}
+
+} // namespace pg
@@ -0,0 +1,82 @@
+#ifndef _POLYGAMMA_MATH_BIQUADBANK_HPP__
+#define _POLYGAMMA_MATH_BIQUADBANK_HPP__
+
+#include <vector>
+
+#include "biquad.hpp"
+
+namespace pg
+{
+
+/**
+ * Every section is evaluated in transposed direct form II. Channels are
+ * processed in pairs, one per lane of an SSE2 register, since the recursion
+ * prevents vectorising along time. Blocks of BLOCK samples of a pair are
+ * transposed into interleaved scratch memory once and then run through every
+ * section of the cascade while they are in cache.
+ *
+ * Only the constructor and setSections() allocate, so a bank may run on the
+ * audio thread.
+ *
+ * @brief A cascade of biquads applied to several planar channels.
+ */
+class BiquadBank final
+{
+public:
+	static constexpr std::size_t BLOCK = 256;
+
+	BiquadBank(std::size_t nChannels,
+	           std::vector<biquad> sections = std::vector<biquad>());
+
+	/**
+	 * The memory of the filters is kept if the number of sections does not
+	 * change, which avoids clicks when retuning.
+	 * @brief Replaces the cascade.
+	 */
+	void setSections(std::vector<biquad> sections);
+	std::vector<biquad> const& getSections() const noexcept;
+	/**
+	 * @brief Replaces one section of the cascade, keeping its memory.
+	 */
+	void setSection(std::size_t index, biquad const&) noexcept;
+	/**
+	 * @brief Clears the memory of the filters.
+	 */
+	void reset() noexcept;
+	/**
+	 * @brief Filters length samples of every channel in place.
+	 * @param[in,out] channels Planar samples, nChannels of them.
+	 */
+	void process(real* const* const channels, std::size_t length) noexcept;
+
+private:
+	void processPair(real* const x0, real* const x1, std::size_t length,
+	                 real* const state) noexcept;
+	void processSingle(real* const x, std::size_t length,
+	                   real* const state) noexcept;
+
+	std::size_t const nChannels;
+	std::vector<biquad> sections;
+	/*
+	 * 2 values per section per channel. A pair of channels stores its sections
+	 * consecutively, with the two lanes interleaved.
+	 */
+	std::vector<real> state;
+	std::vector<real> block; // 2 BLOCK interleaved samples
+};
+
+
+// Implementations
+
+inline std::vector<biquad> const& BiquadBank::getSections() const noexcept
+{
+	return sections;
+}
+inline void BiquadBank::setSection(std::size_t index, biquad const& s) noexcept
+{
+	sections[index] = s;
+}
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_BIQUADBANK_HPP__
@@ -0,0 +1,209 @@
+#include "Convolver.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "parallel.hpp"
+
+namespace pg
+{
+
+// Implementations
+
+constexpr std::size_t Convolver::DIRECT_MAX;
+constexpr std::size_t Convolver::OVERLAP_SAVE_MAX;
+constexpr std::size_t Convolver::PARTITIONS_AUTO;
+constexpr std::size_t Convolver::DIRECT_CHUNK;
+
+Convolver::Convolver(real const* const kernel, std::size_t length,
+                     std::size_t partition):
+	method(Direct), length(length), size(0), nPartitions(0),
+	planForward(nullptr), planInverse(nullptr)
+{
+	assert(length >= 1);
+	assert(!(partition & (partition - 1)));
+	if (!partition && length <= DIRECT_MAX)
+	{
+		reversed.assign(kernel, kernel + length);
+		std::reverse(reversed.begin(), reversed.end());
+		return;
+	}
+
+	if (!partition)
+	{
+		std::size_t const target = length <= OVERLAP_SAVE_MAX ? length :
+		                           length / PARTITIONS_AUTO;
+		partition = 1;
+		while (partition < target) partition *= 2;
+	}
+	size = partition;
+	nPartitions = (length + size - 1) / size;
+	method = nPartitions == 1 ? OverlapSave : Partitioned;
+	planForward = &FFTPlan<real>::get(2 * size, FFTPlan<real>::Forward);
+	planInverse = &FFTPlan<real>::get(2 * size, FFTPlan<real>::Inverse);
+
+	std::size_t const nBins = size + 1;
+	kernelRe.resize(nPartitions * nBins);
+	kernelIm.resize(nPartitions * nBins);
+	std::vector<real> padded(2 * size);
+	std::vector<complex> spectrum(nBins);
+	for (std::size_t p = 0; p < nPartitions; ++p)
+	{
+		std::size_t const n = std::min(size, length - p * size);
+		std::fill(padded.begin(), padded.end(), 0.0);
+		std::copy(kernel + p * size, kernel + p * size + n, padded.begin());
+		planForward->executeReal(spectrum.data(), padded.data());
+		// The normalisation of the inverse transform is folded in here
+		for (std::size_t k = 0; k < nBins; ++k)
+		{
+			kernelRe[p * nBins + k] = spectrum[k].real() / (2 * size);
+			kernelIm[p * nBins + k] = spectrum[k].imag() / (2 * size);
+		}
+	}
+}
+
+Convolver::State Convolver::createState() const
+{
+	State state;
+	state.position = 0;
+	state.ring = 0;
+	if (method == Direct)
+	{
+		state.input.assign(length - 1 + DIRECT_CHUNK, 0.0);
+		return state;
+	}
+	state.input.assign(2 * size, 0.0);
+	state.output.assign(size, 0.0);
+	state.delayRe.assign(nPartitions * (size + 1), 0.0);
+	state.delayIm.assign(nPartitions * (size + 1), 0.0);
+	state.accumulator.resize(2 * (size + 1));
+	state.spectrum.resize(size + 1);
+	return state;
+}
+
+void Convolver::process(State& state, real* const block,
+                        std::size_t length) const noexcept
+{
+	if (method == Direct)
+	{
+		processDirect(state, block, length);
+		return;
+	}
+	std::size_t done = 0;
+	while (done < length)
+	{
+		std::size_t const n = std::min(length - done, size - state.position);
+		std::memcpy(&state.input[size + state.position], block + done,
+		            n * sizeof(real));
+		std::memcpy(block + done, &state.output[state.position],
+		            n * sizeof(real));
+		state.position += n;
+		done += n;
+		if (state.position == size)
+		{
+			partition(state);
+			state.position = 0;
+		}
+	}
+}
+void Convolver::processDirect(State& state, real* const block,
+                              std::size_t n) const noexcept
+{
+	std::size_t const history = length - 1;
+	real* const x = state.input.data();
+	real const* const h = reversed.data();
+	for (std::size_t done = 0; done < n; done += DIRECT_CHUNK)
+	{
+		std::size_t const chunk = std::min(n - done, DIRECT_CHUNK);
+		std::memcpy(x + history, block + done, chunk * sizeof(real));
+		for (std::size_t i = 0; i < chunk; ++i)
+		{
+			real sum = 0.0;
+			for (std::size_t j = 0; j < length; ++j)
+				sum += h[j] * x[i + j];
+			block[done + i] = sum;
+		}
+		std::memmove(x, x + chunk, history * sizeof(real));
+	}
+}
+
+void Convolver::partition(State& state) const noexcept
+{
+	std::size_t const nBins = size + 1;
+	planForward->executeReal(state.spectrum.data(), state.input.data());
+	real* const xRe = &state.delayRe[state.ring * nBins];
+	real* const xIm = &state.delayIm[state.ring * nBins];
+	for (std::size_t k = 0; k < nBins; ++k)
+	{
+		xRe[k] = state.spectrum[k].real();
+		xIm[k] = state.spectrum[k].imag();
+	}
+
+	/*
+	 * Partition p of the kernel meets the input spectrum from p partitions ago.
+	 * The products are accumulated in split layout, which vectorises.
+	 */
+	real* const yRe = state.accumulator.data();
+	real* const yIm = yRe + nBins;
+	std::fill(yRe, yRe + nBins, 0.0);
+	std::fill(yIm, yIm + nBins, 0.0);
+	for (std::size_t p = 0; p < nPartitions; ++p)
+	{
+		std::size_t const slot = (state.ring + nPartitions - p) % nPartitions;
+		real const* const hRe = &kernelRe[p * nBins];
+		real const* const hIm = &kernelIm[p * nBins];
+		real const* const dRe = &state.delayRe[slot * nBins];
+		real const* const dIm = &state.delayIm[slot * nBins];
+		for (std::size_t k = 0; k < nBins; ++k)
+		{
+			yRe[k] += hRe[k] * dRe[k] - hIm[k] * dIm[k];
+			yIm[k] += hRe[k] * dIm[k] + hIm[k] * dRe[k];
+		}
+	}
+	for (std::size_t k = 0; k < nBins; ++k)
+		state.spectrum[k] = complex(yRe[k], yIm[k]);
+	state.ring = (state.ring + 1) % nPartitions;
+
+	/*
+	 * The first half of the circular convolution is aliased, the second half
+	 * is the output. The current partition of input becomes the previous one.
+	 */
+	planInverse->executeReal(yRe, state.spectrum.data());
+	std::memcpy(state.output.data(), yRe + size, size * sizeof(real));
+	std::memcpy(state.input.data(), state.input.data() + size,
+	            size * sizeof(real));
+}
+
+void convolve(real* const* const out, real const* const* const in,
+              std::size_t nChannels, std::size_t length,
+              Convolver const& convolver, std::size_t nThreads)
+{
+	std::size_t const latency = convolver.getLatency();
+	std::size_t const outLength = length + convolver.getKernelLength() - 1;
+	parallelRanges(0, nChannels, threadCount(nThreads, nChannels, 1),
+	               [&](std::size_t first, std::size_t last)
+	{
+		Convolver::State state = convolver.createState();
+		std::vector<real> block(std::max<std::size_t>(latency, 1));
+		for (std::size_t c = first; c < last; ++c)
+		{
+			if (c != first) state = convolver.createState();
+			std::memcpy(out[c], in[c], length * sizeof(real));
+			std::fill(out[c] + length, out[c] + outLength, 0.0);
+			convolver.process(state, out[c], outLength);
+			/*
+			 * The output lags by latency, so it is shifted into place and its
+			 * end obtained by flushing with silence.
+			 */
+			std::size_t const kept = outLength > latency ? outLength - latency : 0;
+			std::memmove(out[c], out[c] + latency, kept * sizeof(real));
+			std::fill(block.begin(), block.end(), 0.0);
+			convolver.process(state, block.data(), latency);
+			std::copy(block.begin() + latency - (outLength - kept),
+			          block.begin() + latency, out[c] + kept);
+		}
+	});
+}
+
+} // namespace pg
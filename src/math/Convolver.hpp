@@ -0,0 +1,160 @@
+#ifndef _POLYGAMMA_MATH_CONVOLVER_HPP__
+#define _POLYGAMMA_MATH_CONVOLVER_HPP__
+
+#include <vector>
+
+#include "../core/polygamma.hpp"
+#include "FFTPlan.hpp"
+
+namespace pg
+{
+
+/**
+ * The method is chosen from the length of the kernel:
+ * - Direct: Time domain dot products, for kernels of up to DIRECT_MAX taps.
+ * - OverlapSave: One FFT block holding the whole kernel, for kernels of up to
+ *   OVERLAP_SAVE_MAX taps.
+ * - Partitioned: The kernel is cut into partitions of equal size whose spectra
+ *   are applied to a delay line of input spectra (uniformly partitioned
+ *   overlap-save), so a long impulse response costs one FFT pair per
+ *   partition of input instead of one FFT of the size of the response.
+ *
+ * The Convolver itself is immutable, so one instance may be shared by any
+ * number of threads. Everything that changes while streaming lives in a State,
+ * one per channel.
+ *
+ * @brief Convolution of streams with a fixed kernel (impulse response).
+ */
+class Convolver final
+{
+public:
+	enum Method
+	{
+		Direct,
+		OverlapSave,
+		Partitioned
+	};
+	static constexpr std::size_t DIRECT_MAX = 32;
+	static constexpr std::size_t OVERLAP_SAVE_MAX = 16384;
+	/**
+	 * Number of partitions aimed for when the partition size is chosen
+	 * automatically.
+	 */
+	static constexpr std::size_t PARTITIONS_AUTO = 8;
+
+	/**
+	 * @brief Streaming state of one channel.
+	 */
+	class State final
+	{
+	public:
+		State() = default;
+
+	private:
+		friend class Convolver;
+
+		/*
+		 * Direct: the last kernel length - 1 inputs, followed by room for a
+		 * chunk. Otherwise: the previous and the current partition of input.
+		 */
+		std::vector<real> input;
+		std::vector<real> output; // The partition being played
+		std::vector<real> delayRe; // Spectra of past input, (size + 1) each
+		std::vector<real> delayIm;
+		/*
+		 * Split spectrum of the output, (size + 1) real then imaginary parts.
+		 * Then reused for the output frame of 2 size samples.
+		 */
+		std::vector<real> accumulator;
+		std::vector<complex> spectrum;
+		std::size_t position; // Samples of the current partition consumed
+		std::size_t ring; // Slot of the delay line receiving the next spectrum
+	};
+
+	/**
+	 * @param[in] kernel The impulse response. Copied.
+	 * @param[in] length Length of kernel. Must be >= 1
+	 * @param[in] partition Size of the partitions, which is also the latency.
+	 *  Must be 0, which chooses the method and size automatically, or a power
+	 *  of 2, which forces OverlapSave or Partitioned.
+	 */
+	Convolver(real const* const kernel, std::size_t length,
+	          std::size_t partition = 0);
+
+	Convolver(Convolver const&) = delete;
+	Convolver& operator=(Convolver const&) = delete;
+
+	Method getMethod() const noexcept;
+	std::size_t getKernelLength() const noexcept;
+	/**
+	 * @brief The delay of the output of process(). 0 for Direct, the partition
+	 *  size otherwise.
+	 */
+	std::size_t getLatency() const noexcept;
+
+	/**
+	 * @brief Creates the state of a channel which has only heard silence.
+	 */
+	State createState() const;
+	/**
+	 * @brief Convolves length samples of one channel in place, delayed by
+	 *  getLatency().
+	 */
+	void process(State&, real* const block, std::size_t length) const noexcept;
+
+private:
+	/**
+	 * @brief Convolves the current partition of input of state, filling its
+	 *  output.
+	 */
+	void partition(State&) const noexcept;
+	void processDirect(State&, real* const block,
+	                   std::size_t length) const noexcept;
+
+	static constexpr std::size_t DIRECT_CHUNK = 4096;
+
+	Method method;
+	std::size_t const length;
+	std::vector<real> reversed; // Direct: the kernel back to front
+
+	std::size_t size; // Partition size
+	std::size_t nPartitions;
+	FFTPlan<real> const* planForward; // 2 size
+	FFTPlan<real> const* planInverse;
+	// Spectra of the zero padded partitions of the kernel, (size + 1) each
+	std::vector<real> kernelRe;
+	std::vector<real> kernelIm;
+};
+
+/**
+ * Channels are distributed over nThreads threads, each streaming with its own
+ * State.
+ * @brief Linear convolution of planar channels with the kernel of convolver.
+ * @param[out] out Planar output. Every channel must hold
+ *  length + convolver.getKernelLength() - 1 samples. May not alias in.
+ * @param[in] in Planar input of length samples per channel.
+ * @param[in] nThreads Number of threads. 0 uses one per hardware thread.
+ */
+void convolve(real* const* const out, real const* const* const in,
+              std::size_t nChannels, std::size_t length,
+              Convolver const& convolver, std::size_t nThreads = 0);
+
+
+// Implementations
+
+inline Convolver::Method Convolver::getMethod() const noexcept
+{
+	return method;
+}
+inline std::size_t Convolver::getKernelLength() const noexcept
+{
+	return length;
+}
+inline std::size_t Convolver::getLatency() const noexcept
+{
+	return method == Direct ? 0 : size;
+}
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_CONVOLVER_HPP__
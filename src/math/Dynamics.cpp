@@ -0,0 +1,211 @@
+#include "Dynamics.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "arithmetic.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace pg
+{
+
+/**
+ * @brief Coefficient of a one pole smoother with time constant t seconds.
+ */
+real smoothingCoefficient(real t, real sampleRate) noexcept;
+
+
+// Implementations
+
+constexpr std::size_t Dynamics::BLOCK;
+constexpr real Dynamics::RMS_WINDOW;
+
+real smoothingCoefficient(real t, real sampleRate) noexcept
+{
+	return t > 0.0 ? std::exp(-1.0 / (t * sampleRate)) : 0.0;
+}
+
+Dynamics::Dynamics(std::size_t nChannels, dynamics const& d,
+                   real sampleRate):
+	nChannels(nChannels), rms(d.rms),
+	threshold(d.threshold), slope(1.0 / d.ratio - 1.0), knee(d.knee),
+	kneeStart(std::pow(10.0, (d.threshold - 0.5 * d.knee) / (rms ? 10 : 20))),
+	attack(smoothingCoefficient(d.attack, sampleRate)),
+	release(smoothingCoefficient(d.release, sampleRate)),
+	average(smoothingCoefficient(RMS_WINDOW, sampleRate)),
+	makeup(std::pow(10.0, d.makeup / 20)),
+	lookahead((std::size_t) std::lround(d.lookahead * sampleRate)),
+	minValues(lookahead + 1), minTimes(lookahead + 1),
+	boxes(std::max<std::size_t>(lookahead, 1)),
+	delay(lookahead * nChannels),
+	gains(BLOCK), scratch(BLOCK * nChannels), scratchChannels(nChannels)
+{
+	for (std::size_t c = 0; c < nChannels; ++c)
+		scratchChannels[c] = &scratch[c * BLOCK];
+	reset();
+}
+
+void Dynamics::reset() noexcept
+{
+	power = 0.0;
+	smoothed = 1.0;
+	minHead = minSize = 0;
+	time = 0;
+	std::fill(boxes.begin(), boxes.end(), 1.0);
+	boxHead = 0;
+	boxSum = boxes.size();
+	std::fill(delay.begin(), delay.end(), 0.0);
+	delayHead = 0;
+}
+
+void Dynamics::process(real* const* const channels,
+                       std::size_t length) noexcept
+{
+	for (std::size_t begin = 0; begin < length; begin += BLOCK)
+	{
+		std::size_t const n = std::min(length - begin, BLOCK);
+		computeGains(channels, begin, n);
+
+		// Swapping the block through the ring delays it by the lookahead
+		std::size_t head = delayHead;
+		for (std::size_t c = 0; c < nChannels; ++c)
+		{
+			real* const x = channels[c] + begin;
+			real* const ring = &delay[c * lookahead];
+			head = delayHead;
+			for (std::size_t i = 0; i < n && lookahead; )
+			{
+				std::size_t const m = std::min(n - i, lookahead - head);
+				std::swap_ranges(x + i, x + i + m, ring + head);
+				i += m;
+				head = head + m == lookahead ? 0 : head + m;
+			}
+			arrayMultiply(x, gains.data(), n);
+		}
+		delayHead = head;
+	}
+}
+void Dynamics::processAligned(real* const* const channels,
+                              std::size_t length) noexcept
+{
+	reset();
+	// Writes trail reads by the lookahead, so the samples are read first
+	std::size_t const total = length + lookahead;
+	for (std::size_t t = 0; t < total; t += BLOCK)
+	{
+		std::size_t const n = std::min(total - t, BLOCK);
+		std::size_t const nIn = t < length ? std::min(n, length - t) : 0;
+		for (std::size_t c = 0; c < nChannels; ++c)
+		{
+			std::copy(channels[c] + t, channels[c] + t + nIn, scratchChannels[c]);
+			std::fill(scratchChannels[c] + nIn, scratchChannels[c] + n, 0.0);
+		}
+		process(scratchChannels.data(), n);
+
+		// Output i of the block is the input at t + i - lookahead
+		std::size_t const skip = t < lookahead ? lookahead - t : 0;
+		if (skip >= n)
+			continue;
+		std::size_t const first = t + skip - lookahead;
+		std::size_t const nOut = std::min(n - skip, length - first);
+		for (std::size_t c = 0; c < nChannels; ++c)
+			std::copy(scratchChannels[c] + skip, scratchChannels[c] + skip + nOut,
+			          channels[c] + first);
+	}
+}
+
+void Dynamics::computeGains(real* const* const channels, std::size_t offset,
+                            std::size_t n) noexcept
+{
+	// Linked level of every sample, the peak or the mean power
+	real* const levels = gains.data();
+	std::fill(levels, levels + n, 0.0);
+	real const scale = rms ? 1.0 / nChannels : 1.0;
+	for (std::size_t c = 0; c < nChannels; ++c)
+	{
+		real const* const x = channels[c] + offset;
+		std::size_t i = 0;
+#ifdef __SSE2__
+		static_assert(sizeof(real) == sizeof(double),
+		              "The SSE2 path assumes double precision");
+		__m128d const mask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+		__m128d const s = _mm_set1_pd(scale);
+		for (; i + 2 <= n; i += 2)
+		{
+			__m128d const v = _mm_loadu_pd(x + i);
+			__m128d const l = _mm_loadu_pd(levels + i);
+			_mm_storeu_pd(levels + i, rms ?
+			              _mm_add_pd(l, _mm_mul_pd(_mm_mul_pd(v, v), s)) :
+			              _mm_max_pd(l, _mm_and_pd(v, mask)));
+		}
+#endif
+		for (; i < n; ++i)
+			levels[i] = rms ? levels[i] + x[i] * x[i] * scale :
+			            std::max(levels[i], std::abs(x[i]));
+	}
+
+	std::size_t const window = minValues.size();
+	real const boxScale = makeup / boxes.size();
+	for (std::size_t i = 0; i < n; ++i, ++time)
+	{
+		real level = levels[i];
+		if (rms)
+			level = power = level + (power - level) * average;
+		real const g = level > kneeStart ? target(level) : 1.0;
+
+		// Minimum of the targets of the last lookahead + 1 samples
+		if (minSize && minTimes[minHead] + lookahead < time)
+		{
+			minHead = minHead + 1 == window ? 0 : minHead + 1;
+			--minSize;
+		}
+		std::size_t back = minHead + minSize;
+		back = back >= window ? back - window : back;
+		while (minSize)
+		{
+			std::size_t const last = back == 0 ? window - 1 : back - 1;
+			if (minValues[last] < g)
+				break;
+			back = last;
+			--minSize;
+		}
+		minValues[back] = g;
+		minTimes[back] = time;
+		++minSize;
+		real const held = minValues[minHead];
+
+		smoothed = held + (smoothed - held) * (held < smoothed ? attack : release);
+
+		// Moving average over the lookahead
+		boxSum += smoothed - boxes[boxHead];
+		boxes[boxHead] = smoothed;
+		boxHead = boxHead + 1 == boxes.size() ? 0 : boxHead + 1;
+		gains[i] = boxSum * boxScale;
+	}
+	// Cancels the rounding errors which the running sum accumulates
+	boxSum = arraySum(boxes.data(), boxes.size());
+}
+
+real Dynamics::target(real level) const noexcept
+{
+	// Natural logarithms and exponentials are cheaper than log10 and pow
+	constexpr real DB_PER_NEPER = 8.685889638065035; // 20 / ln(10)
+	real const over = (rms ? 0.5 : 1.0) * DB_PER_NEPER * std::log(level) -
+	                  threshold;
+	real reduction; // dB
+	if (2 * over < -knee)
+		reduction = 0.0;
+	else if (knee > 0.0 && 2 * over <= knee)
+	{
+		real const x = over + 0.5 * knee;
+		reduction = slope * x * x / (2 * knee);
+	}
+	else
+		reduction = slope * over;
+	return std::exp(reduction / DB_PER_NEPER);
+}
+
+} // namespace pg
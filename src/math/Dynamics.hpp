@@ -0,0 +1,136 @@
+#ifndef _POLYGAMMA_MATH_DYNAMICS_HPP__
+#define _POLYGAMMA_MATH_DYNAMICS_HPP__
+
+#include <vector>
+
+#include "../core/polygamma.hpp"
+
+namespace pg
+{
+
+/**
+ * @brief Parameters of a compressor. A limiter has an infinite ratio, no knee
+ *  and no attack.
+ */
+struct dynamics
+{
+	real threshold; // dBFS
+	real ratio; // At least 1, may be infinite
+	real knee; // Width of the soft knee in dB, centred on the threshold
+	real attack; // Seconds
+	real release; // Seconds
+	real lookahead; // Seconds
+	real makeup; // Gain applied after the compression, in dB
+	bool rms; // Detects the RMS level rather than the peak
+};
+
+/**
+ * The level is detected on all the channels together, as the largest peak or
+ * the mean power, so every channel receives the same gain and the image does
+ * not move. The gain computer only evaluates logarithms above the knee, which
+ * keeps material below the threshold cheap.
+ *
+ * The audio is delayed by the lookahead in a ring buffer, while the target
+ * gain goes through a sliding minimum over the lookahead, the attack and
+ * release smoothing, and a moving average over the lookahead. Without attack
+ * the gain applied to a sample then never exceeds its target, so a limiter
+ * holds its ceiling exactly, and the gain starts moving a lookahead before
+ * the peak.
+ *
+ * Blocks of BLOCK samples are detected and smoothed into an array of gains,
+ * which is then applied to every channel with SSE2.
+ *
+ * @brief A linked compressor and limiter with lookahead.
+ */
+class Dynamics final
+{
+public:
+	static constexpr std::size_t BLOCK = 256;
+	/**
+	 * Time constant of the averaging of the RMS detector in seconds.
+	 */
+	static constexpr real RMS_WINDOW = 0.01;
+
+	Dynamics(std::size_t nChannels, dynamics const&, real sampleRate);
+
+	Dynamics(Dynamics const&) = delete;
+	Dynamics& operator=(Dynamics const&) = delete;
+
+	/**
+	 * @brief Delay of the output in samples, which is the lookahead.
+	 */
+	std::size_t latency() const noexcept;
+	/**
+	 * @brief Returns to rest with an empty delay line.
+	 */
+	void reset() noexcept;
+	/**
+	 * @brief Processes length samples of every channel in place. The output
+	 *  is delayed by latency().
+	 * @param[in,out] channels Planar samples, nChannels of them.
+	 */
+	void process(real* const* const channels, std::size_t length) noexcept;
+	/**
+	 * Starts from rest and flushes the lookahead with silence, so the output
+	 * lines up with the input and covers it entirely.
+	 * @brief Processes length samples of every channel in place without
+	 *  delay.
+	 */
+	void processAligned(real* const* const channels,
+	                    std::size_t length) noexcept;
+
+private:
+	/**
+	 * @brief Detects the level of channels[c][offset + i] for i < n and
+	 *  computes the gains of these samples.
+	 */
+	void computeGains(real* const* const channels, std::size_t offset,
+	                  std::size_t n) noexcept;
+	/**
+	 * @brief Target gain, in linear units, of a level.
+	 * @param[in] level Peak, or mean power for the RMS detector.
+	 */
+	real target(real level) const noexcept;
+
+	std::size_t const nChannels;
+	bool const rms;
+	real threshold; // dB
+	real slope; // 1 / ratio - 1
+	real knee; // dB
+	real kneeStart; // Level at which the gain computer engages
+	real attack; // Smoothing coefficients
+	real release;
+	real average; // Coefficient of the RMS detector
+	real makeup; // Linear
+	std::size_t const lookahead;
+
+	// State of the detector and of the smoothing
+	real power;
+	real smoothed;
+	std::vector<real> minValues; // Monotonic queue, a ring of lookahead + 1
+	std::vector<std::size_t> minTimes;
+	std::size_t minHead, minSize;
+	std::size_t time;
+	std::vector<real> boxes; // Ring of the last max(lookahead, 1) gains
+	std::size_t boxHead;
+	real boxSum;
+
+	std::vector<real> delay; // Ring of lookahead samples per channel
+	std::size_t delayHead;
+
+	std::vector<real> gains; // BLOCK
+	std::vector<real> scratch; // BLOCK per channel, for processAligned
+	std::vector<real*> scratchChannels;
+};
+
+
+// Implementations
+
+inline std::size_t Dynamics::latency() const noexcept
+{
+	return lookahead;
+}
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_DYNAMICS_HPP__
@@ -0,0 +1,94 @@
+#include "Envelope.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "arithmetic.hpp"
+
+namespace pg
+{
+
+// Implementations
+
+Envelope::Envelope(real value): value(value)
+{
+}
+
+void Envelope::insert(std::size_t position, real v, CurveType curve)
+{
+	auto const it = std::lower_bound(points.begin(), points.end(), position,
+	                                 [](Point const& p, std::size_t q)
+	{
+		return p.position < q;
+	});
+	if (it != points.end() && it->position == position)
+		*it = Point{position, v, curve};
+	else
+		points.insert(it, Point{position, v, curve});
+}
+bool Envelope::erase(std::size_t position) noexcept
+{
+	auto const it = std::lower_bound(points.begin(), points.end(), position,
+	                                 [](Point const& p, std::size_t q)
+	{
+		return p.position < q;
+	});
+	if (it == points.end() || it->position != position)
+		return false;
+	points.erase(it);
+	return true;
+}
+void Envelope::clear() noexcept
+{
+	points.clear();
+}
+
+real Envelope::valueAt(std::size_t position) const noexcept
+{
+	real result;
+	render(&result, position, 1);
+	return result;
+}
+void Envelope::render(real* const out, real position, std::size_t length,
+                      real step) const noexcept
+{
+	if (points.empty())
+	{
+		std::fill(out, out + length, value);
+		return;
+	}
+
+	// The first breakpoint after the block, then every one within it
+	auto next = std::upper_bound(points.begin(), points.end(), position,
+	                             [](real p, Point const& q)
+	{
+		return p < q.position;
+	});
+	std::size_t i = 0;
+	while (i < length)
+	{
+		real const here = position + i * step;
+		// Large steps may pass several breakpoints at once
+		while (next != points.end() && next->position <= here)
+			++next;
+		std::size_t n = length - i;
+		if (next != points.end() && step > 0.0)
+			n = std::min<real>(n, std::ceil((next->position - here) / step));
+		if (next == points.end())
+			std::fill(out + i, out + i + n, points.back().value);
+		else if (next == points.begin())
+			std::fill(out + i, out + i + n, next->value);
+		else
+		{
+			Point const& a = next[-1];
+			Point const& b = *next;
+			real const dt = 1.0 / (b.position - a.position);
+			curveRender(out + i, n, a.curve, (here - a.position) * dt, step * dt);
+			arrayScale(out + i, n, b.value - a.value);
+			arrayAdd(out + i, n, a.value);
+		}
+		i += n;
+	}
+}
+
+} // namespace pg
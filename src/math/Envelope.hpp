@@ -0,0 +1,82 @@
+#ifndef _POLYGAMMA_MATH_ENVELOPE_HPP__
+#define _POLYGAMMA_MATH_ENVELOPE_HPP__
+
+#include <vector>
+
+#include "../core/polygamma.hpp"
+#include "curve.hpp"
+
+namespace pg
+{
+
+/**
+ * The breakpoints are kept sorted by position, at most one per position. The
+ * envelope holds the value of the first breakpoint before it and the value of
+ * the last one after it. Between two breakpoints it follows the curve of the
+ * first one, scaled to run from its value to the value of the second.
+ *
+ * render() costs one binary search per call plus the curve recurrences, so
+ * rendering in blocks amortises the search over the block.
+ *
+ * @brief Piecewise curve defined by breakpoints, e.g. for automation.
+ */
+class Envelope final
+{
+public:
+	struct Point
+	{
+		std::size_t position;
+		real value;
+		CurveType curve; // Shape of the segment which begins at this point
+	};
+
+	/**
+	 * @param[in] value Value of the envelope while it has no breakpoint.
+	 */
+	explicit Envelope(real value = 1.0);
+
+	/**
+	 * @brief Adds a breakpoint, replacing the one at the same position.
+	 */
+	void insert(std::size_t position, real value, CurveType);
+	/**
+	 * @brief Removes the breakpoint at position, if any.
+	 * @return true if there was one.
+	 */
+	bool erase(std::size_t position) noexcept;
+	void clear() noexcept;
+	std::vector<Point> const& getPoints() const noexcept;
+	std::size_t size() const noexcept;
+
+	real valueAt(std::size_t position) const noexcept;
+	/**
+	 * Fractional positions lie on the curves between samples, so the envelope
+	 * can be traversed at another speed, e.g. at the rate of a stretched
+	 * playback.
+	 * @brief Renders the values at position + i * step for i < length into
+	 *  out.
+	 * @param[in] step Must be >= 0
+	 */
+	void render(real* const out, real position, std::size_t length,
+	            real step = 1.0) const noexcept;
+
+private:
+	real value;
+	std::vector<Point> points;
+};
+
+
+// Implementations
+
+inline std::vector<Envelope::Point> const& Envelope::getPoints() const noexcept
+{
+	return points;
+}
+inline std::size_t Envelope::size() const noexcept
+{
+	return points.size();
+}
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_ENVELOPE_HPP__
@@ -0,0 +1,700 @@
+#include "FFTPlan.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+namespace pg
+{
+
+/**
+ * @brief Multiplies x by w. Written out to avoid the special cases of
+ *  std::complex multiplication.
+ */
+template <typename T>
+std::complex<T> twiddle(std::complex<T> x, std::complex<T> w) noexcept;
+
+
+// Implementations
+
+template <typename T>
+constexpr std::size_t FFTPlan<T>::SPLIT_MIN;
+template <typename T>
+constexpr std::size_t FFTPlan<T>::BATCH_WIDTH;
+template <typename T>
+constexpr std::size_t FFTPlan<T>::BATCH_MAX;
+
+template <typename T>
+inline std::complex<T> twiddle(std::complex<T> x, std::complex<T> w) noexcept
+{
+	return std::complex<T>(x.real() * w.real() - x.imag() * w.imag(),
+	                       x.real() * w.imag() + x.imag() * w.real());
+}
+
+template <typename T>
+FFTPlan<T> const& FFTPlan<T>::get(std::size_t length, Direction direction)
+{
+	static std::mutex mutex;
+	static std::map<std::pair<std::size_t, Direction>,
+	                std::unique_ptr<FFTPlan>> cache;
+
+	std::unique_ptr<FFTPlan>* plan;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		plan = &cache[std::make_pair(length, direction)];
+		if (*plan) return **plan;
+	}
+	/*
+	 * Created outside of the lock since the plan of half the length is
+	 * requested recursively. Should two threads race here, the loser's plan is
+	 * discarded.
+	 */
+	std::unique_ptr<FFTPlan> created(new FFTPlan(length, direction));
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!*plan) *plan = std::move(created);
+	return **plan;
+}
+
+template <typename T>
+FFTPlan<T>::FFTPlan(std::size_t length, Direction direction):
+	length(length), direction(direction), algorithm(Radix2), scratchSize(0),
+	log2(0), convolutionForward(nullptr), convolutionInverse(nullptr),
+	half(nullptr)
+{
+	assert(length);
+	/*
+	 * Every factor is evaluated directly in double precision so that no
+	 * rounding error accumulates.
+	 */
+	double const sign = direction == Forward ? -1.0 : 1.0;
+
+	std::size_t rest = length;
+	for (std::size_t p: {4, 2, 3, 5})
+		while (rest % p == 0)
+		{
+			factors.push_back(p);
+			rest /= p;
+		}
+
+	if (!(length & (length - 1)))
+	{
+		factors.clear();
+		while ((std::size_t) 1 << log2 < length) ++log2;
+		reversal.resize(length);
+		for (std::size_t i = 0; i < length; ++i)
+		{
+			std::size_t r = 0;
+			for (std::size_t b = 0; b < log2; ++b)
+				r |= (i >> b & 1) << (log2 - 1 - b);
+			reversal[i] = r;
+		}
+
+		for (std::size_t m = log2 & 1 ? 2 : 1; m < length; m *= 4)
+		{
+			std::size_t const offset = twiddlesSplit.size();
+			twiddlesSplit.resize(offset + 6 * m);
+			for (std::size_t k = 0; k < m; ++k)
+				for (std::size_t j = 1; j <= 3; ++j)
+				{
+					double const theta = sign * 2 * M_PI * j * k / (4 * m);
+					twiddles.push_back(Complex(std::cos(theta), std::sin(theta)));
+					twiddlesSplit[offset + (2 * j - 2) * m + k] = std::cos(theta);
+					twiddlesSplit[offset + (2 * j - 1) * m + k] = std::sin(theta);
+				}
+		}
+		if (length <= BATCH_MAX)
+		{
+			twiddlesBatch.reserve(twiddlesSplit.size() * BATCH_WIDTH);
+			for (T const w: twiddlesSplit)
+				twiddlesBatch.insert(twiddlesBatch.end(), BATCH_WIDTH, w);
+		}
+		// Split copy of the data
+		scratchSize = length >= SPLIT_MIN ? length : 0;
+	}
+	else if (rest == 1)
+	{
+		algorithm = MixedRadix;
+		std::size_t n = length;
+		for (std::size_t const p: factors)
+		{
+			std::size_t const m = n / p;
+			for (std::size_t q = 0; q < m; ++q)
+				for (std::size_t k = 1; k < p; ++k)
+				{
+					double const theta = sign * 2 * M_PI * q * k / n;
+					twiddlesMixed.push_back(Complex(std::cos(theta), std::sin(theta)));
+				}
+			n = m;
+		}
+		// Ping-pong buffer of the stages
+		scratchSize = length;
+	}
+	else
+	{
+		/*
+		 * Bluestein: jk = (j^2 + k^2 - (k - j)^2) / 2 turns the transform into
+		 * the convolution of x_j c_j with conj(c_n), where c_n is the chirp.
+		 * The convolution is circular over a power of 2 long enough for no
+		 * wrap-around to reach the first length outputs.
+		 */
+		algorithm = Bluestein;
+		factors.clear();
+		std::size_t size = 1;
+		while (size < 2 * length - 1) size *= 2;
+
+		for (std::size_t k = 0; k < length; ++k)
+		{
+			// k^2 modulo 2 length keeps the argument small
+			double const theta = sign * M_PI * (k * k % (2 * length)) / length;
+			chirp.push_back(Complex(std::cos(theta), std::sin(theta)));
+		}
+		convolutionForward = &get(size, Forward);
+		convolutionInverse = &get(size, Inverse);
+
+		chirpSpectrum.assign(size, Complex(0));
+		chirpSpectrum[0] = std::conj(chirp[0]);
+		for (std::size_t k = 1; k < length; ++k)
+			chirpSpectrum[k] = chirpSpectrum[size - k] = std::conj(chirp[k]);
+		convolutionForward->transform(chirpSpectrum.data(), chirpSpectrum.data(),
+		                              T(1) / size,
+		                              convolutionForward->threadScratch());
+		scratchSize = size + convolutionForward->getScratchSize();
+	}
+
+	if (length >= 2 && length % 2 == 0)
+	{
+		for (std::size_t k = 0; k < length / 2; ++k)
+		{
+			double const theta = sign * 2 * M_PI * k / length;
+			twiddlesReal.push_back(Complex(std::cos(theta), std::sin(theta)));
+		}
+		half = &get(length / 2, direction);
+		scratchSize = std::max(scratchSize, half->getScratchSize());
+	}
+	else
+	{
+		// The real transforms of odd lengths take a complex copy
+		scratchSize += length;
+	}
+}
+
+template <typename T>
+typename FFTPlan<T>::Complex* FFTPlan<T>::threadScratch() const
+{
+	thread_local std::vector<Complex> scratch;
+	if (scratch.size() < scratchSize)
+		scratch.resize(scratchSize);
+	return scratch.data();
+}
+
+template <typename T>
+void FFTPlan<T>::execute(Complex* const data) const noexcept
+{
+	transform(data, data, 1, threadScratch());
+}
+template <typename T>
+void FFTPlan<T>::execute(Complex* const out, Complex const* const in,
+                         T scale) const noexcept
+{
+	transform(out, in, scale, threadScratch());
+}
+template <typename T>
+void FFTPlan<T>::execute(Complex* const out, Complex const* const in,
+                         T scale, Complex* const scratch) const noexcept
+{
+	transform(out, in, scale, scratch);
+}
+
+template <typename T>
+void FFTPlan<T>::executeSplit(T* const re, T* const im) const noexcept
+{
+	if (algorithm != Radix2)
+	{
+		thread_local std::vector<Complex> scratch;
+		if (scratch.size() < length)
+			scratch.resize(length);
+		for (std::size_t i = 0; i < length; ++i)
+			scratch[i] = Complex(re[i], im[i]);
+		transform(scratch.data(), scratch.data(), 1, threadScratch());
+		for (std::size_t i = 0; i < length; ++i)
+		{
+			re[i] = scratch[i].real();
+			im[i] = scratch[i].imag();
+		}
+		return;
+	}
+
+	for (std::size_t i = 0; i < length; ++i)
+		if (i < reversal[i])
+		{
+			std::swap(re[i], re[reversal[i]]);
+			std::swap(im[i], im[reversal[i]]);
+		}
+	stagesSplit(re, im, simdSupported());
+}
+
+template <typename T>
+void FFTPlan<T>::executeBatch(T* const re, T* const im,
+                              std::size_t nFrames) const noexcept
+{
+	std::size_t f = 0;
+	SIMD const simd = simdSupported();
+	if (algorithm == Radix2 && length <= BATCH_MAX && length >= 2 &&
+	    simd != SIMDScalar)
+	{
+		std::size_t const W = BATCH_WIDTH;
+		thread_local std::vector<T> scratch;
+		if (scratch.size() < 2 * W * length)
+			scratch.resize(2 * W * length);
+		T* const sr = scratch.data();
+		T* const si = sr + W * length;
+		for (; f + W <= nFrames; f += W)
+		{
+			// The transposition is fused with the bit reversal
+			T* const fr = re + f * length;
+			T* const fi = im + f * length;
+			for (std::size_t i = 0; i < length; ++i)
+			{
+				T* const dr = sr + reversal[i] * W;
+				T* const di = si + reversal[i] * W;
+				for (std::size_t j = 0; j < W; ++j)
+				{
+					dr[j] = fr[j * length + i];
+					di[j] = fi[j * length + i];
+				}
+			}
+			stagesBatch(sr, si, simd);
+			for (std::size_t i = 0; i < length; ++i)
+				for (std::size_t j = 0; j < W; ++j)
+				{
+					fr[j * length + i] = sr[i * W + j];
+					fi[j * length + i] = si[i * W + j];
+				}
+		}
+	}
+	// Frames which do not fill a batch
+	for (; f < nFrames; ++f)
+		executeSplit(re + f * length, im + f * length);
+}
+
+template <typename T>
+void FFTPlan<T>::executeReal(Complex* const spectrum,
+                             T const* const signal) const noexcept
+{
+	executeReal(spectrum, signal, threadScratch());
+}
+template <typename T>
+void FFTPlan<T>::executeReal(Complex* const spectrum, T const* const signal,
+                             Complex* const scratch) const noexcept
+{
+	assert(direction == Forward);
+	if (!half)
+	{
+		// Odd lengths have no half length plan and take the complex transform
+		for (std::size_t i = 0; i < length; ++i)
+			scratch[i] = signal[i];
+		transform(scratch, scratch, 1, scratch + length);
+		std::copy(scratch, scratch + length / 2 + 1, spectrum);
+		return;
+	}
+	std::size_t const n = length / 2;
+
+	/*
+	 * Transform the even samples as the real parts and the odd samples as the
+	 * imaginary parts. The layout of std::complex guarantees that the signal
+	 * can be read as such.
+	 */
+	half->transform(spectrum, reinterpret_cast<Complex const*>(signal), 1,
+	                scratch);
+
+	/*
+	 * Separate the spectra E and O of the even and odd samples from Z = E + iO
+	 * and combine them to X[k] = E[k] + w^k O[k]. The bins k and n - k are
+	 * computed together since each needs the other.
+	 */
+	Complex const z0 = spectrum[0];
+	spectrum[0] = z0.real() + z0.imag();
+	spectrum[n] = z0.real() - z0.imag();
+	for (std::size_t k = 1; k <= n / 2; ++k)
+	{
+		std::size_t const m = n - k;
+		Complex const zk = spectrum[k];
+		Complex const zm = spectrum[m];
+		Complex const e = T(0.5) * (zk + std::conj(zm));
+		Complex const d = T(0.5) * (zk - std::conj(zm));
+		Complex const o(d.imag(), -d.real()); // d / i
+		spectrum[k] = e + twiddle(o, twiddlesReal[k]);
+		if (m != k)
+			spectrum[m] = std::conj(e) + twiddle(std::conj(o), twiddlesReal[m]);
+	}
+}
+template <typename T>
+void FFTPlan<T>::executeReal(T* const signal, Complex const* const spectrum,
+                             T scale) const noexcept
+{
+	executeReal(signal, spectrum, scale, threadScratch());
+}
+template <typename T>
+void FFTPlan<T>::executeReal(T* const signal, Complex const* const spectrum,
+                             T scale, Complex* const scratch) const noexcept
+{
+	assert(direction == Inverse);
+	if (!half)
+	{
+		// Complete the Hermitian spectrum for the complex transform
+		scratch[0] = Complex(spectrum[0].real());
+		for (std::size_t k = 1; k <= length / 2; ++k)
+		{
+			scratch[k] = spectrum[k];
+			scratch[length - k] = std::conj(spectrum[k]);
+		}
+		transform(scratch, scratch, scale, scratch + length);
+		for (std::size_t i = 0; i < length; ++i)
+			signal[i] = scratch[i].real();
+		return;
+	}
+	std::size_t const n = length / 2;
+
+	/*
+	 * Reassemble Z = E + iO. The layout of std::complex guarantees that signal
+	 * can hold the half length transform, whose real and imaginary parts then
+	 * fall on the even and odd samples.
+	 */
+	Complex* const z = reinterpret_cast<Complex*>(signal);
+	for (std::size_t k = 0; k < n; ++k)
+	{
+		// The bins 0 and n of a real signal are real
+		Complex const xk = k ? spectrum[k] : Complex(spectrum[0].real());
+		Complex const xm = k ? std::conj(spectrum[n - k]) :
+		                       Complex(spectrum[n].real());
+		// 2E and 2O, which makes the result length times the signal
+		Complex const e = xk + xm;
+		Complex const o = twiddle(xk - xm, twiddlesReal[k]);
+		z[k] = Complex(e.real() - o.imag(), e.imag() + o.real());
+	}
+	half->transform(z, z, scale, scratch);
+}
+
+template <typename T>
+void FFTPlan<T>::transform(Complex* const out, Complex const* const in,
+                           T scale, Complex* const scratch) const noexcept
+{
+	switch (algorithm)
+	{
+	case MixedRadix:
+		transformMixedRadix(out, in, scale, scratch);
+		break;
+	case Bluestein:
+		transformBluestein(out, in, scale, scratch);
+		break;
+	default:
+		transformRadix2(out, in, scale, scratch);
+		break;
+	}
+}
+template <typename T>
+void FFTPlan<T>::transformRadix2(Complex* const out, Complex const* const in,
+                                 T scale, Complex* const scratch) const noexcept
+{
+	SIMD const simd = simdSupported();
+	if (simd == SIMDScalar || length < SPLIT_MIN)
+	{
+		if (in == out)
+		{
+			for (std::size_t i = 0; i < length; ++i)
+				if (i < reversal[i])
+					std::swap(out[i], out[reversal[i]]);
+			if (scale != 1)
+				for (std::size_t i = 0; i < length; ++i)
+					out[i] *= scale;
+		}
+		else
+			for (std::size_t i = 0; i < length; ++i)
+				out[reversal[i]] = in[i] * scale;
+
+		if (direction == Forward)
+			stagesReference<false>(out);
+		else
+			stagesReference<true>(out);
+		return;
+	}
+
+	// The permutation is fused with the conversion to split layout
+	T* const re = reinterpret_cast<T*>(scratch);
+	T* const im = re + length;
+	for (std::size_t i = 0; i < length; ++i)
+	{
+		re[reversal[i]] = in[i].real() * scale;
+		im[reversal[i]] = in[i].imag() * scale;
+	}
+	stagesSplit(re, im, simd);
+	for (std::size_t i = 0; i < length; ++i)
+		out[i] = Complex(re[i], im[i]);
+}
+template <typename T>
+void FFTPlan<T>::transformMixedRadix(Complex* const out,
+                                     Complex const* const in,
+                                     T scale,
+                                     Complex* const scratch) const noexcept
+{
+	/*
+	 * Stockham stages alternate between out and the scratch without any
+	 * permutation. Start from whichever makes the last stage write into out.
+	 */
+	Complex* x = factors.size() % 2 ? scratch : out;
+	Complex* y = x == out ? scratch : out;
+	for (std::size_t i = 0; i < length; ++i)
+		x[i] = in[i] * scale;
+
+	T const sign = direction == Forward ? -1 : 1;
+	T const sin3 = sign * std::sqrt(T(3)) / 2;
+	T const cos5a = std::cos(2 * M_PI / 5), cos5b = std::cos(4 * M_PI / 5);
+	T const sin5a = sign * std::sin(2 * M_PI / 5);
+	T const sin5b = sign * std::sin(4 * M_PI / 5);
+	// Multiplication by i
+	auto const j = [](Complex z)
+	{
+		return Complex(-z.imag(), z.real());
+	};
+
+	/*
+	 * Each stage splits s interleaved transforms of length n into p s
+	 * transforms of length m = n / p.
+	 */
+	Complex const* w = twiddlesMixed.data();
+	std::size_t n = length;
+	std::size_t s = 1;
+	for (std::size_t const p: factors)
+	{
+		std::size_t const m = n / p;
+		for (std::size_t q = 0; q < m; ++q)
+		{
+			Complex const* const wq = w + q * (p - 1);
+			for (std::size_t t = 0; t < s; ++t)
+			{
+				Complex const* const a = x + t + s * q;
+				Complex* const b = y + t + s * p * q;
+				std::size_t const ms = m * s;
+				switch (p)
+				{
+				case 2:
+				{
+					Complex const a0 = a[0], a1 = a[ms];
+					b[0] = a0 + a1;
+					b[s] = twiddle(a0 - a1, wq[0]);
+					break;
+				}
+				case 3:
+				{
+					Complex const a0 = a[0], a1 = a[ms], a2 = a[2 * ms];
+					Complex const t1 = a1 + a2;
+					Complex const t2 = a0 - t1 * T(0.5);
+					Complex const t3 = j(a1 - a2) * sin3;
+					b[0] = a0 + t1;
+					b[s] = twiddle(t2 + t3, wq[0]);
+					b[2 * s] = twiddle(t2 - t3, wq[1]);
+					break;
+				}
+				case 4:
+				{
+					Complex const a0 = a[0], a1 = a[ms], a2 = a[2 * ms], a3 = a[3 * ms];
+					Complex const s0 = a0 + a2, s1 = a0 - a2;
+					Complex const s2 = a1 + a3;
+					// Multiplication by -i, or by i if inverse
+					Complex const s3 = j(a1 - a3) * sign;
+					b[0] = s0 + s2;
+					b[s] = twiddle(s1 + s3, wq[0]);
+					b[2 * s] = twiddle(s0 - s2, wq[1]);
+					b[3 * s] = twiddle(s1 - s3, wq[2]);
+					break;
+				}
+				default:
+				{
+					Complex const a0 = a[0];
+					Complex const u1 = a[ms] + a[4 * ms], v1 = a[ms] - a[4 * ms];
+					Complex const u2 = a[2 * ms] + a[3 * ms], v2 = a[2 * ms] - a[3 * ms];
+					Complex const r1 = a0 + u1 * cos5a + u2 * cos5b;
+					Complex const r2 = a0 + u1 * cos5b + u2 * cos5a;
+					Complex const i1 = j(v1 * sin5a + v2 * sin5b);
+					Complex const i2 = j(v1 * sin5b - v2 * sin5a);
+					b[0] = a0 + u1 + u2;
+					b[s] = twiddle(r1 + i1, wq[0]);
+					b[2 * s] = twiddle(r2 + i2, wq[1]);
+					b[3 * s] = twiddle(r2 - i2, wq[2]);
+					b[4 * s] = twiddle(r1 - i1, wq[3]);
+					break;
+				}
+				}
+			}
+		}
+		w += m * (p - 1);
+		n = m;
+		s *= p;
+		std::swap(x, y);
+	}
+}
+template <typename T>
+void FFTPlan<T>::transformBluestein(Complex* const out,
+                                    Complex const* const in,
+                                    T scale,
+                                    Complex* const scratch) const noexcept
+{
+	std::size_t const size = chirpSpectrum.size();
+	Complex* const a = scratch;
+
+	for (std::size_t k = 0; k < length; ++k)
+		a[k] = twiddle(in[k] * scale, chirp[k]);
+	std::fill(a + length, a + size, Complex(0));
+	convolutionForward->transform(a, a, 1, scratch + size);
+	for (std::size_t k = 0; k < size; ++k)
+		a[k] = twiddle(a[k], chirpSpectrum[k]);
+	convolutionInverse->transform(a, a, 1, scratch + size);
+	for (std::size_t k = 0; k < length; ++k)
+		out[k] = twiddle(a[k], chirp[k]);
+}
+template <typename T>
+void FFTPlan<T>::stagesSplit(T* const re, T* const im,
+                             SIMD simd) const noexcept
+{
+	bool const inverse = direction == Inverse;
+	std::size_t m = 1;
+	if (log2 & 1)
+	{
+		for (std::size_t i = 0; i < length; i += 2)
+		{
+			T const ar = re[i], ai = im[i];
+			re[i] = ar + re[i + 1];
+			im[i] = ai + im[i + 1];
+			re[i + 1] = ar - re[i + 1];
+			im[i + 1] = ai - im[i + 1];
+		}
+		m = 2;
+	}
+
+	std::size_t const lanes = fftLanes<T>(simd);
+	T const* w = twiddlesSplit.data();
+	for (; m < length; m *= 4)
+	{
+		// The first stages are too short to fill a vector
+		switch (m < lanes ? SIMDScalar : simd)
+		{
+		case SIMDAVX512:
+			fftRadix4AVX512(re, im, length, m, w, inverse);
+			break;
+		case SIMDAVX2:
+			fftRadix4AVX2(re, im, length, m, w, inverse);
+			break;
+		case SIMDSSE2:
+			fftRadix4SSE2(re, im, length, m, w, inverse);
+			break;
+		default:
+			fftRadix4Scalar(re, im, length, m, w, inverse);
+			break;
+		}
+		w += 6 * m;
+	}
+}
+template <typename T>
+void FFTPlan<T>::stagesBatch(T* const re, T* const im,
+                             SIMD simd) const noexcept
+{
+	std::size_t const W = BATCH_WIDTH;
+	bool const inverse = direction == Inverse;
+	std::size_t m = 1;
+	if (log2 & 1)
+	{
+		for (std::size_t i = 0; i < length * W; i += 2 * W)
+			for (std::size_t j = i; j < i + W; ++j)
+			{
+				T const ar = re[j], ai = im[j];
+				re[j] = ar + re[j + W];
+				im[j] = ai + im[j + W];
+				re[j + W] = ar - re[j + W];
+				im[j + W] = ai - im[j + W];
+			}
+		m = 2;
+	}
+
+	/*
+	 * Each element is a run of W frames and each twiddle factor is repeated W
+	 * times, so a stage over sub-transforms of length m is the ordinary kernel
+	 * over sub-transforms of length m W. That is a multiple of the lanes, even
+	 * for the first stages.
+	 */
+	T const* w = twiddlesBatch.data();
+	for (; m < length; m *= 4)
+	{
+		switch (simd)
+		{
+		case SIMDAVX512:
+			fftRadix4AVX512(re, im, length * W, m * W, w, inverse);
+			break;
+		case SIMDAVX2:
+			fftRadix4AVX2(re, im, length * W, m * W, w, inverse);
+			break;
+		case SIMDSSE2:
+			fftRadix4SSE2(re, im, length * W, m * W, w, inverse);
+			break;
+		default:
+			fftRadix4Scalar(re, im, length * W, m * W, w, inverse);
+			break;
+		}
+		w += 6 * m * W;
+	}
+}
+template <typename T> template <bool inverse>
+void FFTPlan<T>::stagesReference(Complex* const x) const noexcept
+{
+	std::size_t m = 1;
+	if (log2 & 1)
+	{
+		for (std::size_t i = 0; i < length; i += 2)
+		{
+			Complex const a = x[i];
+			x[i] = a + x[i + 1];
+			x[i + 1] = a - x[i + 1];
+		}
+		m = 2;
+	}
+
+	Complex const* w = twiddles.data();
+	for (; m < length; m *= 4)
+	{
+		/*
+		 * In bit reversed order, the four sub-transforms of a block of 4m hold
+		 * the samples whose indices are 0, 2, 1 and 3 modulo 4 respectively.
+		 */
+		for (std::size_t base = 0; base < length; base += 4 * m)
+		{
+			Complex* const p = x + base;
+			for (std::size_t k = 0; k < m; ++k)
+			{
+				Complex const a = p[k];
+				Complex const c = twiddle(p[k + m], w[3 * k + 1]);
+				Complex const b = twiddle(p[k + 2 * m], w[3 * k]);
+				Complex const d = twiddle(p[k + 3 * m], w[3 * k + 2]);
+				Complex const s0 = a + c;
+				Complex const s1 = a - c;
+				Complex const s2 = b + d;
+				Complex const s3 = b - d;
+				// Multiplication of s3 by -i, or by i if inverse
+				Complex const s3j = inverse ? Complex(-s3.imag(), s3.real()) :
+				                              Complex(s3.imag(), -s3.real());
+				p[k] = s0 + s2;
+				p[k + m] = s1 + s3j;
+				p[k + 2 * m] = s0 - s2;
+				p[k + 3 * m] = s1 - s3j;
+			}
+		}
+		w += 3 * m;
+	}
+}
+
+template class FFTPlan<float>;
+template class FFTPlan<double>;
+
+} // namespace pg
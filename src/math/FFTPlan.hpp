@@ -0,0 +1,268 @@
+#ifndef _POLYGAMMA_MATH_FFTPLAN_HPP__
+#define _POLYGAMMA_MATH_FFTPLAN_HPP__
+
+#include <complex>
+#include <vector>
+
+#include "../core/polygamma.hpp"
+#include "fftKernels.hpp"
+
+namespace pg
+{
+
+/**
+ * A plan holds everything a transform of one length needs that does not
+ * depend on the data: the bit reversal permutation, the twiddle factors of
+ * every stage and the size of the scratch memory. Plans are immutable once
+ * created, so any number of threads may execute the same plan concurrently.
+ *
+ * Any length is supported. Powers of 2 use radix-2/4 stages, lengths of the
+ * form 2^a 3^b 5^c use self-sorting mixed radix stages, and all other lengths
+ * use Bluestein's algorithm, which is a convolution of power of 2 length
+ * about four times as long.
+ *
+ * Plans are obtained from a process wide cache keyed by length, direction and
+ * precision (T = float or double), so repeated transforms of the same length
+ * pay no setup cost. The transforms are unnormalised.
+ *
+ * Transforms of at least SPLIT_MIN points run on the split (SoA) radix-4
+ * kernels of the best instruction set found by simdSupported(). Smaller ones,
+ * and all transforms when simdLimit(SIMDScalar) is set, run the interleaved
+ * scalar reference.
+ *
+ * Batches of short power of 2 transforms interleave BATCH_WIDTH frames so that
+ * each vector lane works on a different frame. Every stage, including the
+ * first ones which are too short to fill a vector within one frame, then runs
+ * on the vector kernels.
+ *
+ * @brief Precomputed fast Fourier transform of one length.
+ */
+template <typename T>
+class FFTPlan final
+{
+public:
+	typedef std::complex<T> Complex;
+
+	static constexpr std::size_t SPLIT_MIN = 64;
+	/**
+	 * Number of frames interleaved by executeBatch(), which fills the widest
+	 * vector of any instruction set.
+	 */
+	static constexpr std::size_t BATCH_WIDTH = 64 / sizeof(T);
+	/**
+	 * executeBatch() interleaves frames of power of 2 lengths up to this. Longer
+	 * frames fill the vectors on their own.
+	 */
+	static constexpr std::size_t BATCH_MAX = 256;
+
+	enum Direction
+	{
+		Forward, // exp(-2 pi i jk / n)
+		Inverse // exp(+2 pi i jk / n)
+	};
+	enum Algorithm
+	{
+		Radix2,
+		MixedRadix,
+		Bluestein
+	};
+
+	/**
+	 * Thread-safe. The plan is created upon the first request and lives until
+	 * the end of the program, so the reference may be kept.
+	 * @brief Obtains the plan from the cache.
+	 * @param length Must be >= 1.
+	 */
+	static FFTPlan const& get(std::size_t length, Direction);
+
+	FFTPlan(FFTPlan const&) = delete;
+	FFTPlan& operator=(FFTPlan const&) = delete;
+
+	std::size_t getLength() const noexcept;
+	Direction getDirection() const noexcept;
+	Algorithm getAlgorithm() const noexcept;
+	/**
+	 * @brief Number of Complex elements of scratch memory used by execute()
+	 *  and executeReal().
+	 */
+	std::size_t getScratchSize() const noexcept;
+
+	/*
+	 * The transforms which take no scratch use memory owned by the calling
+	 * thread, which is allocated upon the first transform of a thread. Threads
+	 * which must not allocate, such as the audio thread, pass their own
+	 * scratch of getScratchSize() elements instead.
+	 */
+
+	/**
+	 * @brief In-place transform of data of getLength() elements.
+	 */
+	void execute(Complex* const data) const noexcept;
+	/**
+	 * in and out must not overlap.
+	 * @brief Out of place transform, multiplying the output by scale.
+	 */
+	void execute(Complex* const out, Complex const* const in,
+	             T scale = 1) const noexcept;
+	/**
+	 * in may equal out.
+	 * @brief Transform with caller scratch, multiplying the output by scale.
+	 */
+	void execute(Complex* const out, Complex const* const in, T scale,
+	             Complex* const scratch) const noexcept;
+	/**
+	 * @brief In-place transform of data in split layout: re and im hold the
+	 *  real and imaginary parts of getLength() elements.
+	 */
+	void executeSplit(T* const re, T* const im) const noexcept;
+	/**
+	 * @brief In-place transform of nFrames frames in split layout: frame f is
+	 *  held by re[f * getLength() + i] and im[f * getLength() + i] for
+	 *  i < getLength().
+	 */
+	void executeBatch(T* const re, T* const im,
+	                  std::size_t nFrames) const noexcept;
+	/**
+	 * Only valid for Forward plans. Uses the plan of half the length if the
+	 * length is even.
+	 * @brief Transforms the real signal of getLength() samples into
+	 *  getLength() / 2 + 1 bins.
+	 */
+	void executeReal(Complex* const spectrum,
+	                 T const* const signal) const noexcept;
+	void executeReal(Complex* const spectrum, T const* const signal,
+	                 Complex* const scratch) const noexcept;
+	/**
+	 * Only valid for Inverse plans. Uses the plan of half the length if the
+	 * length is even.
+	 * @brief Transforms getLength() / 2 + 1 bins of the spectrum of a real
+	 *  signal into getLength() samples, multiplied by scale. The imaginary
+	 *  parts of the bin 0, and of the bin getLength() / 2 if the length is
+	 *  even, are ignored.
+	 */
+	void executeReal(T* const signal, Complex const* const spectrum,
+	                 T scale = 1) const noexcept;
+	void executeReal(T* const signal, Complex const* const spectrum, T scale,
+	                 Complex* const scratch) const noexcept;
+
+private:
+	FFTPlan(std::size_t length, Direction);
+
+	/**
+	 * @brief Scratch of getScratchSize() elements owned by the calling thread.
+	 */
+	Complex* threadScratch() const;
+	/**
+	 * @brief Transforms in, multiplied by scale, into out. in may equal out.
+	 * @param scratch getScratchSize() elements, less any used by the real
+	 *  transforms only.
+	 */
+	void transform(Complex* const out, Complex const* const in, T scale,
+	               Complex* const scratch) const noexcept;
+	// Implementations of transform() for each algorithm
+	void transformRadix2(Complex* const out, Complex const* const in,
+	                     T scale, Complex* const scratch) const noexcept;
+	void transformMixedRadix(Complex* const out, Complex const* const in,
+	                         T scale, Complex* const scratch) const noexcept;
+	void transformBluestein(Complex* const out, Complex const* const in,
+	                        T scale, Complex* const scratch) const noexcept;
+	/**
+	 * @brief Scalar reference of the stages, applied to data which is already
+	 *  in bit reversed order.
+	 */
+	template <bool inverse>
+	void stagesReference(Complex* const data) const noexcept;
+	/**
+	 * @brief Split layout variant of stagesReference().
+	 */
+	void stagesSplit(T* const re, T* const im, SIMD) const noexcept;
+	/**
+	 * @brief Stages of BATCH_WIDTH interleaved frames already in bit reversed
+	 *  order: element i of frame f is held at re[i * BATCH_WIDTH + f].
+	 */
+	void stagesBatch(T* const re, T* const im, SIMD) const noexcept;
+
+	std::size_t const length;
+	Direction const direction;
+	Algorithm algorithm;
+	std::size_t scratchSize;
+
+	// Radix2
+	std::size_t log2;
+	std::vector<std::size_t> reversal;
+	/*
+	 * Twiddles of the radix-4 stages in the order of execution. The stage
+	 * which combines four sub-transforms of length m stores w^k, w^2k, w^3k
+	 * for every k < m, where w = exp(-+2 pi i / 4m).
+	 */
+	std::vector<Complex> twiddles;
+	/*
+	 * The same twiddles in split layout. Each stage stores the six arrays
+	 * expected by the radix-4 kernels, see fftKernels.hpp.
+	 */
+	std::vector<T> twiddlesSplit;
+	/*
+	 * twiddlesSplit with every factor repeated BATCH_WIDTH times, which turns
+	 * the kernels into ones over interleaved frames. Only for lengths up to
+	 * BATCH_MAX.
+	 */
+	std::vector<T> twiddlesBatch;
+
+	// MixedRadix
+	std::vector<std::size_t> factors; // 4, 2, 3 and 5 in the order of execution
+	/*
+	 * The stage of radix p which splits transforms of length n into p of
+	 * length m = n / p stores w^qk for every q < m and 0 < k < p, where
+	 * w = exp(-+2 pi i / n).
+	 */
+	std::vector<Complex> twiddlesMixed;
+
+	// Bluestein
+	std::vector<Complex> chirp; // exp(+-pi i k^2 / length) for k < length
+	// Transform of the chirp of the convolution length, divided by that length
+	std::vector<Complex> chirpSpectrum;
+	FFTPlan const* convolutionForward;
+	FFTPlan const* convolutionInverse;
+
+	/*
+	 * exp(-+2 pi i k / length) for k < length / 2, used by the real transforms
+	 * of this length.
+	 */
+	std::vector<Complex> twiddlesReal;
+	/*
+	 * Plan of half the length used by the real transforms. nullptr if the
+	 * length is odd.
+	 */
+	FFTPlan const* half;
+};
+
+extern template class FFTPlan<float>;
+extern template class FFTPlan<double>;
+
+
+// Implementations
+
+template <typename T> inline std::size_t
+FFTPlan<T>::getLength() const noexcept
+{
+	return length;
+}
+template <typename T> inline typename FFTPlan<T>::Direction
+FFTPlan<T>::getDirection() const noexcept
+{
+	return direction;
+}
+template <typename T> inline typename FFTPlan<T>::Algorithm
+FFTPlan<T>::getAlgorithm() const noexcept
+{
+	return algorithm;
+}
+template <typename T> inline std::size_t
+FFTPlan<T>::getScratchSize() const noexcept
+{
+	return scratchSize;
+}
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_FFTPLAN_HPP__
@@ -0,0 +1,94 @@
+#include "OverlapAdd.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace pg
+{
+
+// Implementations
+
+OverlapAdd::OverlapAdd(std::size_t nChannels,
+                       real const* const analysis, real const* const synthesis,
+                       std::size_t windowLength, std::size_t hop):
+	nChannels(nChannels), windowLength(windowLength), hop(hop),
+	planForward(FFTPlan<real>::get(windowLength, FFTPlan<real>::Forward)),
+	planInverse(FFTPlan<real>::get(windowLength, FFTPlan<real>::Inverse)),
+	analysis(analysis, analysis + windowLength),
+	synthesis(synthesis, synthesis + windowLength),
+	normalisation(hop),
+	input(windowLength * nChannels), accumulator(windowLength * nChannels),
+	output(hop * nChannels), buffer(windowLength), spectrum(windowLength / 2 + 1),
+	position(0)
+{
+	assert(windowLength >= 2 && hop >= 1 && hop <= windowLength);
+
+	real weightMax = 0.0;
+	for (std::size_t k = 0; k < windowLength; ++k)
+		weightMax = std::max(weightMax, std::abs(analysis[k] * synthesis[k]));
+	for (std::size_t i = 0; i < hop; ++i)
+	{
+		real weight = 0.0;
+		for (std::size_t k = i; k < windowLength; k += hop)
+			weight += analysis[k] * synthesis[k];
+		normalisation[i] = std::abs(weight) > weightMax * 1e-9 ? 1.0 / weight : 0.0;
+	}
+}
+
+void OverlapAdd::process(real* const* const block, std::size_t length,
+                         Processor const& processor) noexcept
+{
+	std::size_t done = 0;
+	while (done < length)
+	{
+		std::size_t const n = std::min(length - done, hop - position);
+		for (std::size_t c = 0; c < nChannels; ++c)
+		{
+			std::memcpy(&input[c * windowLength + windowLength - hop + position],
+			            block[c] + done, n * sizeof(real));
+			std::memcpy(block[c] + done, &output[c * hop + position],
+			            n * sizeof(real));
+		}
+		position += n;
+		done += n;
+		if (position == hop)
+		{
+			frame(processor);
+			position = 0;
+		}
+	}
+}
+void OverlapAdd::reset() noexcept
+{
+	std::fill(input.begin(), input.end(), 0.0);
+	std::fill(accumulator.begin(), accumulator.end(), 0.0);
+	std::fill(output.begin(), output.end(), 0.0);
+	position = 0;
+}
+
+void OverlapAdd::frame(Processor const& processor) noexcept
+{
+	for (std::size_t c = 0; c < nChannels; ++c)
+	{
+		real* const in = &input[c * windowLength];
+		real* const acc = &accumulator[c * windowLength];
+		for (std::size_t k = 0; k < windowLength; ++k)
+			buffer[k] = analysis[k] * in[k];
+		planForward.executeReal(spectrum.data(), buffer.data());
+		processor(c, spectrum.data());
+		planInverse.executeReal(buffer.data(), spectrum.data(), 1.0 / windowLength);
+		for (std::size_t k = 0; k < windowLength; ++k)
+			acc[k] += synthesis[k] * buffer[k];
+
+		// The first hop samples have received all of their frames
+		for (std::size_t i = 0; i < hop; ++i)
+			output[c * hop + i] = acc[i] * normalisation[i];
+		std::memmove(acc, acc + hop, (windowLength - hop) * sizeof(real));
+		std::fill(acc + windowLength - hop, acc + windowLength, 0.0);
+		std::memmove(in, in + hop, (windowLength - hop) * sizeof(real));
+	}
+}
+
+} // namespace pg
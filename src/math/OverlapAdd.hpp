@@ -0,0 +1,124 @@
+#ifndef _POLYGAMMA_MATH_OVERLAPADD_HPP__
+#define _POLYGAMMA_MATH_OVERLAPADD_HPP__
+
+#include <functional>
+#include <vector>
+
+#include "../core/polygamma.hpp"
+#include "FFTPlan.hpp"
+
+namespace pg
+{
+
+/**
+ * The input is consumed in blocks of any length. Every hop samples, the last
+ * windowLength samples of each channel are multiplied by the analysis window,
+ * transformed, handed to the processor, transformed back, multiplied by the
+ * synthesis window and overlap-added. Hence the output lags the input by
+ * getLatency() samples, and the memory used does not depend on the length of
+ * the stream.
+ *
+ * The output is divided by the sum of analysis[k] * synthesis[k] over the
+ * frames covering each sample, so an identity processor reproduces the input
+ * exactly, once getLatency() samples have passed, for any pair of windows
+ * whose products summed over every residue modulo hop stay above 1e-9 of the
+ * largest product. Residues below are output as silence.
+ *
+ * @brief Streaming short-time Fourier analysis and resynthesis.
+ */
+class OverlapAdd final
+{
+public:
+	/**
+	 * @brief Modifies the getBins() bins of the current frame of channel in
+	 *  place.
+	 */
+	typedef std::function<void (std::size_t channel, complex* spectrum)>
+	Processor;
+
+	/**
+	 * @param[in] analysis, synthesis Windows of windowLength samples. Copied.
+	 * @param[in] windowLength Must be >= 2
+	 * @param[in] hop Must be in [1, windowLength]
+	 */
+	OverlapAdd(std::size_t nChannels,
+	           real const* const analysis, real const* const synthesis,
+	           std::size_t windowLength, std::size_t hop);
+
+	OverlapAdd(OverlapAdd const&) = delete;
+	OverlapAdd& operator=(OverlapAdd const&) = delete;
+
+	std::size_t getWindowLength() const noexcept;
+	std::size_t getHop() const noexcept;
+	/**
+	 * @brief Number of bins of each frame, windowLength / 2 + 1.
+	 */
+	std::size_t getBins() const noexcept;
+	/**
+	 * To obtain the tail of a stream, process getLatency() samples of silence
+	 * after it.
+	 * @brief The delay of the output, windowLength samples.
+	 */
+	std::size_t getLatency() const noexcept;
+
+	/**
+	 * @brief Processes length samples of every channel in place.
+	 * @param[in,out] block Planar input, replaced by the output.
+	 */
+	void process(real* const* const block, std::size_t length,
+	             Processor const& processor) noexcept;
+	/**
+	 * @brief Forgets the stream, as if only silence had been processed.
+	 */
+	void reset() noexcept;
+
+private:
+	/**
+	 * @brief Analyses and resynthesises the current frame of every channel,
+	 *  making hop new samples available in output.
+	 */
+	void frame(Processor const&) noexcept;
+
+	std::size_t const nChannels;
+	std::size_t const windowLength;
+	std::size_t const hop;
+
+	FFTPlan<real> const& planForward;
+	FFTPlan<real> const& planInverse;
+	std::vector<real> analysis;
+	std::vector<real> synthesis;
+	// Reciprocal of the window overlap, hop. 0 where the overlap vanishes
+	std::vector<real> normalisation;
+
+	std::vector<real> input; // windowLength per channel
+	std::vector<real> accumulator; // windowLength per channel
+	std::vector<real> output; // hop per channel
+	std::vector<real> buffer; // windowLength
+	std::vector<complex> spectrum; // windowLength / 2 + 1
+	// Samples of the current hop consumed and played
+	std::size_t position;
+};
+
+
+// Implementations
+
+inline std::size_t OverlapAdd::getWindowLength() const noexcept
+{
+	return windowLength;
+}
+inline std::size_t OverlapAdd::getHop() const noexcept
+{
+	return hop;
+}
+inline std::size_t OverlapAdd::getBins() const noexcept
+{
+	return windowLength / 2 + 1;
+}
+inline std::size_t OverlapAdd::getLatency() const noexcept
+{
+	return windowLength;
+}
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_OVERLAPADD_HPP__
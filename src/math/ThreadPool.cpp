@@ -0,0 +1,89 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace pg
+{
+
+/*
+ * Set while the thread executes a task. Jobs submitted from within a task are
+ * executed inline, since the caller could otherwise wait on workers which are
+ * themselves waiting.
+ */
+static thread_local bool threadPoolInTask = false;
+
+
+// Implementations
+
+ThreadPool& ThreadPool::get()
+{
+	static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1U) - 1);
+	return pool;
+}
+
+ThreadPool::ThreadPool(std::size_t nWorkers): stopping(false)
+{
+	for (std::size_t i = 0; i < nWorkers; ++i)
+		workers.emplace_back(&ThreadPool::work, this);
+}
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	available.notify_all();
+	for (auto& worker: workers)
+		worker.join();
+}
+
+void ThreadPool::run(std::size_t nTasks, Task const& task)
+{
+	if (workers.empty() || nTasks <= 1 || threadPoolInTask)
+	{
+		bool const inTask = threadPoolInTask;
+		threadPoolInTask = true;
+		for (std::size_t i = 0; i < nTasks; ++i)
+			task(i);
+		threadPoolInTask = inTask;
+		return;
+	}
+
+	Job job{&task, nTasks, 0, 0};
+	std::unique_lock<std::mutex> lock(mutex);
+	jobs.push_back(&job);
+	available.notify_all();
+	while (job.next < job.nTasks)
+		execute(job, lock);
+	// The job must outlive the tasks which the workers are still executing
+	finished.wait(lock, [&job] { return job.done == job.nTasks; });
+}
+
+void ThreadPool::work()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		available.wait(lock, [this] { return stopping || !jobs.empty(); });
+		if (jobs.empty())
+			return;
+		execute(*jobs.front(), lock);
+	}
+}
+void ThreadPool::execute(Job& job, std::unique_lock<std::mutex>& lock)
+{
+	std::size_t const i = job.next++;
+	if (job.next == job.nTasks)
+		jobs.erase(std::find(jobs.begin(), jobs.end(), &job));
+
+	lock.unlock();
+	threadPoolInTask = true;
+	(*job.task)(i);
+	threadPoolInTask = false;
+	lock.lock();
+
+	if (++job.done == job.nTasks)
+		finished.notify_all();
+}
+
+} // namespace pg
@@ -0,0 +1,93 @@
+#ifndef _POLYGAMMA_MATH_THREADPOOL_HPP__
+#define _POLYGAMMA_MATH_THREADPOOL_HPP__
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pg
+{
+
+/**
+ * Work is submitted as jobs of numbered tasks. The threads of the pool and the
+ * thread which submits a job all take tasks from it until none is left, so a
+ * job always progresses even when the pool is busy with other jobs.
+ *
+ * A job submitted from within a task runs entirely on the thread of that
+ * task. Tasks may therefore use functions that are parallel themselves
+ * without deadlocking the pool.
+ *
+ * @brief Fixed set of worker threads which execute jobs.
+ */
+class ThreadPool final
+{
+public:
+	typedef std::function<void (std::size_t)> Task;
+
+	/**
+	 * Thread-safe. The pool has one thread per hardware thread except the
+	 * calling one, and lives until the end of the program.
+	 * @brief Obtains the process wide pool.
+	 */
+	static ThreadPool& get();
+
+	/**
+	 * @param[in] nWorkers Number of threads to start. 0 makes run()
+	 *  sequential.
+	 */
+	explicit ThreadPool(std::size_t nWorkers);
+	~ThreadPool();
+
+	ThreadPool(ThreadPool const&) = delete;
+	ThreadPool& operator=(ThreadPool const&) = delete;
+
+	/**
+	 * @brief Number of threads that may work on one job, including the caller.
+	 */
+	std::size_t getConcurrency() const noexcept;
+	/**
+	 * Thread-safe. Tasks must not throw.
+	 * @brief Calls task(i) for every i < nTasks in parallel and returns once
+	 *  all of them have finished.
+	 */
+	void run(std::size_t nTasks, Task const& task);
+
+private:
+	struct Job
+	{
+		Task const* task;
+		std::size_t nTasks;
+		std::size_t next; // Next task to take
+		std::size_t done; // Number of tasks finished
+	};
+
+	void work();
+	/**
+	 * Must be called with the mutex locked, which is released while the task
+	 * executes.
+	 * @brief Takes the next task of the job and executes it.
+	 */
+	void execute(Job&, std::unique_lock<std::mutex>&);
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable available; // Signalled when a job is submitted
+	std::condition_variable finished; // Signalled when a job is done
+	std::deque<Job*> jobs; // Jobs with tasks left to take
+	bool stopping;
+};
+
+
+// Implementations
+
+inline std::size_t ThreadPool::getConcurrency() const noexcept
+{
+	return workers.size() + 1;
+}
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_THREADPOOL_HPP__
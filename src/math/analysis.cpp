@@ -0,0 +1,315 @@
+#include "analysis.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "BiquadBank.hpp"
+#include "parallel.hpp"
+#include "window.hpp"
+
+namespace pg
+{
+
+/*
+ * The signal is measured in steps of 100 ms, which are grouped into chunks of
+ * CHUNK_STEPS steps of one channel, the unit of work of a thread. The
+ * K-weighting filter of every chunk starts WARMUP_STEPS steps early, by which
+ * time its response to the missing history has decayed far below the
+ * precision of real, so the chunks need not be filtered in sequence.
+ */
+constexpr std::size_t CHUNK_STEPS = 32;
+constexpr std::size_t WARMUP_STEPS = 5;
+constexpr std::size_t MOMENTARY_STEPS = 4;
+constexpr std::size_t SHORT_TERM_STEPS = 30;
+/*
+ * The true peak is interpolated at the 3 fractional positions between
+ * samples by windowed sinc filters of 2 TRUE_PEAK_RADIUS taps, as suggested
+ * by BS.1770-4 annex 2.
+ */
+constexpr std::size_t OVERSAMPLING = 4;
+constexpr std::ptrdiff_t TRUE_PEAK_RADIUS = 6;
+constexpr real TRUE_PEAK_BETA = 8.0;
+
+/**
+ * @brief Measurements of one step of one channel.
+ */
+struct analysisStep
+{
+	real peak;
+	real truePeak;
+	real squares; // Sum of the squares of the samples
+	real weighted; // Sum of the squares of the K-weighted samples
+};
+
+/**
+ * @brief Converts the mean square of K-weighted samples into LUFS.
+ */
+real loudness(real meanSquare) noexcept;
+real decibels(real amplitude) noexcept;
+/**
+ * @brief Taps of the fractional phases 1 to OVERSAMPLING - 1, each of
+ *  2 TRUE_PEAK_RADIUS taps and unity gain at DC.
+ */
+real const* truePeakTaps();
+/**
+ * @brief Largest magnitude interpolated between the samples
+ *  [begin, end[ of x.
+ * @param[out] padded Scratch memory for end - begin + 2 TRUE_PEAK_RADIUS
+ *  samples.
+ */
+real truePeakRange(real const* const x, std::size_t length,
+                   std::size_t begin, std::size_t end,
+                   real* const padded) noexcept;
+
+
+// Implementations
+
+inline real loudness(real meanSquare) noexcept
+{
+	return -0.691 + 10 * std::log10(meanSquare);
+}
+inline real decibels(real amplitude) noexcept
+{
+	return 20 * std::log10(amplitude);
+}
+
+real const* truePeakTaps()
+{
+	static std::vector<real> const taps = []
+	{
+		std::size_t const nTaps = 2 * TRUE_PEAK_RADIUS;
+		/*
+		 * The window spans the taps in units of 1 / OVERSAMPLING, so tap k of
+		 * phase p lies at index OVERSAMPLING (k + TRUE_PEAK_RADIUS) - p.
+		 */
+		real const* const kaiser = window(WindowKaiser, OVERSAMPLING * nTaps,
+		                                  TRUE_PEAK_BETA);
+		std::vector<real> result((OVERSAMPLING - 1) * nTaps);
+		for (std::size_t p = 1; p < OVERSAMPLING; ++p)
+		{
+			real* const h = &result[(p - 1) * nTaps];
+			real sum = 0.0;
+			for (std::size_t j = 0; j < nTaps; ++j)
+			{
+				// Distance from the interpolated position to the sample
+				real const u = (real) j - (TRUE_PEAK_RADIUS - 1) -
+				               (real) p / OVERSAMPLING;
+				h[j] = std::sin(M_PI * u) / (M_PI * u) *
+				       kaiser[OVERSAMPLING * (j + 1) - p];
+				sum += h[j];
+			}
+			for (std::size_t j = 0; j < nTaps; ++j)
+				h[j] /= sum;
+		}
+		return result;
+	}();
+	return taps.data();
+}
+real truePeakRange(real const* const x, std::size_t length,
+                   std::size_t begin, std::size_t end,
+                   real* const padded) noexcept
+{
+	std::size_t const nTaps = 2 * TRUE_PEAK_RADIUS;
+	std::size_t const n = end - begin;
+	// padded[i] holds x[begin - TRUE_PEAK_RADIUS + 1 + i], zero outside of x
+	for (std::size_t i = 0; i < n + nTaps - 1; ++i)
+	{
+		std::ptrdiff_t const j = (std::ptrdiff_t) (begin + i) - TRUE_PEAK_RADIUS + 1;
+		padded[i] = j >= 0 && (std::size_t) j < length ? x[j] : 0.0;
+	}
+
+	real const* const taps = truePeakTaps();
+	real result = 0.0;
+	for (std::size_t p = 0; p < OVERSAMPLING - 1; ++p)
+	{
+		real const* const h = taps + p * nTaps;
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			real y = 0.0;
+			for (std::size_t k = 0; k < nTaps; ++k)
+				y += h[k] * padded[i + k];
+			result = std::max(result, std::abs(y));
+		}
+	}
+	return result;
+}
+
+std::vector<biquad> loudnessWeighting(real sampleRate)
+{
+	/*
+	 * BS.1770 specifies the coefficients at 48 kHz only. These are the analogue
+	 * prototypes they were derived from, transformed bilinearly.
+	 */
+	std::vector<biquad> result(2);
+	{
+		real const k = std::tan(M_PI * 1681.974450955533 / sampleRate);
+		real const q = 0.7071752369554196;
+		real const vh = std::pow(10.0, 3.999843853973347 / 20);
+		real const vb = std::pow(vh, 0.4996667741545416);
+		real const a0 = 1 + k / q + k * k;
+		result[0] = biquad{(vh + vb * k / q + k * k) / a0,
+		                   2 * (k * k - vh) / a0,
+		                   (vh - vb * k / q + k * k) / a0,
+		                   2 * (k * k - 1) / a0,
+		                   (1 - k / q + k * k) / a0};
+	}
+	{
+		real const k = std::tan(M_PI * 38.13547087602444 / sampleRate);
+		real const q = 0.5003270373238773;
+		real const a0 = 1 + k / q + k * k;
+		result[1] = biquad{1.0, -2.0, 1.0,
+		                   2 * (k * k - 1) / a0,
+		                   (1 - k / q + k * k) / a0};
+	}
+	return result;
+}
+
+Analysis analyze(real const* const* const channels, std::size_t nChannels,
+                 std::size_t length, real sampleRate,
+                 real const* const weights, std::size_t nThreads)
+{
+	real const infinity = std::numeric_limits<real>::infinity();
+	std::size_t const step = std::max<std::size_t>(std::lround(sampleRate * 0.1), 1);
+	std::size_t const nSteps = (length + step - 1) / step;
+	std::size_t const nChunks = (nSteps + CHUNK_STEPS - 1) / CHUNK_STEPS;
+	std::vector<biquad> const weighting = loudnessWeighting(sampleRate);
+
+	// Step s of channel c is at steps[c * nSteps + s]
+	std::vector<analysisStep> steps(nChannels * nSteps);
+	std::size_t const nItems = nChannels * nChunks;
+	parallelRanges(0, nItems, threadCount(nThreads, nItems, 1),
+	               [&](std::size_t first, std::size_t last)
+	{
+		std::vector<real> block(step);
+		std::vector<real> padded(step + 2 * TRUE_PEAK_RADIUS);
+		for (std::size_t item = first; item < last; ++item)
+		{
+			std::size_t const c = item / nChunks;
+			std::size_t const s0 = item % nChunks * CHUNK_STEPS;
+			std::size_t const s1 = std::min(s0 + CHUNK_STEPS, nSteps);
+			real const* const x = channels[c];
+
+			BiquadBank bank(1, weighting);
+			real* const blockData = block.data();
+			for (std::size_t i = s0 > WARMUP_STEPS ? (s0 - WARMUP_STEPS) * step : 0;
+			     i < s0 * step; i += step)
+			{
+				std::copy(x + i, x + i + step, blockData);
+				bank.process(&blockData, step);
+			}
+
+			for (std::size_t s = s0; s < s1; ++s)
+			{
+				std::size_t const begin = s * step;
+				std::size_t const end = std::min(begin + step, length);
+				analysisStep& result = steps[c * nSteps + s];
+				result.peak = result.squares = result.weighted = 0.0;
+				for (std::size_t i = begin; i < end; ++i)
+				{
+					result.peak = std::max(result.peak, std::abs(x[i]));
+					result.squares += x[i] * x[i];
+				}
+				result.truePeak = std::max(result.peak,
+				                           truePeakRange(x, length, begin, end,
+				                                         padded.data()));
+				std::copy(x + begin, x + end, blockData);
+				bank.process(&blockData, end - begin);
+				for (std::size_t i = 0; i < end - begin; ++i)
+					result.weighted += block[i] * block[i];
+			}
+		}
+	});
+
+	/*
+	 * The reductions below run in a fixed order on the calling thread, so the
+	 * sums are reproducible to the last bit.
+	 */
+	Analysis analysis;
+	analysis.blockDuration = step / sampleRate;
+	for (std::size_t c = 0; c < nChannels; ++c)
+	{
+		real peak = 0.0, truePeak = 0.0, squares = 0.0;
+		for (std::size_t s = 0; s < nSteps; ++s)
+		{
+			analysisStep const& st = steps[c * nSteps + s];
+			peak = std::max(peak, st.peak);
+			truePeak = std::max(truePeak, st.truePeak);
+			squares += st.squares;
+		}
+		analysis.peak.push_back(decibels(peak));
+		analysis.truePeak.push_back(decibels(truePeak));
+		analysis.rms.push_back(length ? decibels(std::sqrt(squares / length)) :
+		                       -infinity);
+	}
+
+	// Weighted energy of every step, summed over the channels
+	std::vector<real> energy(nSteps, 0.0);
+	for (std::size_t s = 0; s < nSteps; ++s)
+	{
+		real peak = 0.0, squares = 0.0;
+		for (std::size_t c = 0; c < nChannels; ++c)
+		{
+			analysisStep const& st = steps[c * nSteps + s];
+			peak = std::max(peak, st.peak);
+			squares += st.squares;
+			energy[s] += (weights ? weights[c] : 1.0) * st.weighted;
+		}
+		std::size_t const n = nChannels * (std::min((s + 1) * step, length) - s * step);
+		analysis.blockPeak.push_back(decibels(peak));
+		analysis.blockRMS.push_back(n ? decibels(std::sqrt(squares / n)) : -infinity);
+	}
+
+	analysis.momentaryMax = analysis.shortTermMax = -infinity;
+	std::vector<real> gated; // Mean squares of the complete gating blocks
+	for (std::size_t s = 0; s < nSteps; ++s)
+	{
+		// Direct sums rather than sliding ones, which would accumulate rounding
+		real momentary = 0.0, shortTerm = 0.0;
+		for (std::size_t t = s + 1 >= SHORT_TERM_STEPS ? s + 1 - SHORT_TERM_STEPS : 0;
+		     t <= s; ++t)
+		{
+			shortTerm += energy[t];
+			if (t + MOMENTARY_STEPS > s)
+				momentary += energy[t];
+		}
+		real const m = momentary / (MOMENTARY_STEPS * step);
+		analysis.momentary.push_back(loudness(m));
+		analysis.shortTerm.push_back(loudness(shortTerm / (SHORT_TERM_STEPS * step)));
+		analysis.momentaryMax = std::max(analysis.momentaryMax,
+		                                 analysis.momentary.back());
+		analysis.shortTermMax = std::max(analysis.shortTermMax,
+		                                 analysis.shortTerm.back());
+		// The last step may be incomplete
+		if (s + 1 >= MOMENTARY_STEPS && (s + 1) * step <= length)
+			gated.push_back(m);
+	}
+
+	// Absolute gate at -70 LUFS, then relative gate 10 LU below what remains
+	real sum = 0.0;
+	std::size_t count = 0;
+	for (real const m: gated)
+		if (loudness(m) > -70.0)
+		{
+			sum += m;
+			++count;
+		}
+	analysis.integrated = -infinity;
+	if (count)
+	{
+		real const relative = loudness(sum / count) - 10.0;
+		sum = 0.0;
+		count = 0;
+		for (real const m: gated)
+			if (loudness(m) > -70.0 && loudness(m) > relative)
+			{
+				sum += m;
+				++count;
+			}
+		if (count)
+			analysis.integrated = loudness(sum / count);
+	}
+	return analysis;
+}
+
+} // namespace pg
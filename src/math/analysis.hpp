@@ -0,0 +1,65 @@
+#ifndef _POLYGAMMA_MATH_ANALYSIS_HPP__
+#define _POLYGAMMA_MATH_ANALYSIS_HPP__
+
+#include <vector>
+
+#include "../core/polygamma.hpp"
+#include "biquad.hpp"
+
+namespace pg
+{
+
+/**
+ * Levels are in dB relative to full scale and loudness in LUFS according to
+ * ITU-R BS.1770-4 and EBU R128. Silence and measurements without any gating
+ * block left are -infinity.
+ *
+ * The series have one entry per block of blockDuration seconds (100 ms, the
+ * step of the loudness gating blocks). Entry j of momentary and shortTerm is
+ * the loudness of the 400 ms and 3 s windows ending with block j, as if the
+ * signal were preceded by silence.
+ *
+ * @brief Level and loudness measurements of a multichannel signal.
+ */
+struct Analysis
+{
+	// Per channel
+	std::vector<real> peak;
+	std::vector<real> truePeak; // 4x oversampled, in dBTP
+	std::vector<real> rms;
+
+	real integrated; // Gated programme loudness
+	real momentaryMax;
+	real shortTermMax;
+
+	real blockDuration;
+	// Per block, over all channels
+	std::vector<real> blockPeak;
+	std::vector<real> blockRMS;
+	std::vector<real> momentary;
+	std::vector<real> shortTerm;
+};
+
+/**
+ * @brief The two sections of the K-weighting filter of BS.1770: a high shelf
+ *  modelling the head followed by the revised low frequency B-curve high pass.
+ */
+std::vector<biquad> loudnessWeighting(real sampleRate);
+/**
+ * The result does not depend on the number of threads: every block is
+ * measured on its own and the blocks are summed in order afterwards.
+ * Samples beyond the signal count as silence when oversampling.
+ * @brief Measures planar channels of length samples each.
+ * @param[in] weights Weight of every channel in the loudness sum, 1 for the
+ *  front channels, 1.41 for the surround channels and 0 for the LFE. nullptr
+ *  weighs every channel 1.
+ * @param[in] nThreads 0 uses every hardware thread.
+ */
+Analysis analyze(real const* const* const channels, std::size_t nChannels,
+                 std::size_t length, real sampleRate,
+                 real const* const weights = nullptr,
+                 std::size_t nThreads = 0);
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_ANALYSIS_HPP__
@@ -0,0 +1,147 @@
+#include "arithmetic.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace pg
+{
+
+#ifdef __SSE2__
+static_assert(sizeof(real) == sizeof(double),
+              "The SSE2 paths assume double precision");
+#endif
+
+// Implementations
+
+void arrayScale(real* const x, std::size_t length, real gain) noexcept
+{
+	std::size_t i = 0;
+#ifdef __SSE2__
+	__m128d const g = _mm_set1_pd(gain);
+	for (; i + 4 <= length; i += 4)
+	{
+		_mm_storeu_pd(x + i, _mm_mul_pd(_mm_loadu_pd(x + i), g));
+		_mm_storeu_pd(x + i + 2, _mm_mul_pd(_mm_loadu_pd(x + i + 2), g));
+	}
+#endif
+	for (; i < length; ++i)
+		x[i] *= gain;
+}
+void arrayRamp(real* const x, std::size_t length,
+               real gain, real increment) noexcept
+{
+	std::size_t i = 0;
+#ifdef __SSE2__
+	// Lanes hold the gains of i and i + 1
+	__m128d g = _mm_set_pd(gain + increment, gain);
+	__m128d const step = _mm_set1_pd(2 * increment);
+	for (; i + 2 <= length; i += 2)
+	{
+		_mm_storeu_pd(x + i, _mm_mul_pd(_mm_loadu_pd(x + i), g));
+		g = _mm_add_pd(g, step);
+	}
+#endif
+	for (; i < length; ++i)
+		x[i] *= gain + i * increment;
+}
+void arrayMultiply(real* const x, real const* const gains,
+                   std::size_t length) noexcept
+{
+	std::size_t i = 0;
+#ifdef __SSE2__
+	for (; i + 2 <= length; i += 2)
+		_mm_storeu_pd(x + i, _mm_mul_pd(_mm_loadu_pd(x + i),
+		                                _mm_loadu_pd(gains + i)));
+#endif
+	for (; i < length; ++i)
+		x[i] *= gains[i];
+}
+void arrayMultiplyAdd(real* const x, real const* const y,
+                      real const* const gains, std::size_t length) noexcept
+{
+	std::size_t i = 0;
+#ifdef __SSE2__
+	for (; i + 2 <= length; i += 2)
+		_mm_storeu_pd(x + i, _mm_add_pd(_mm_loadu_pd(x + i),
+		                                _mm_mul_pd(_mm_loadu_pd(y + i),
+		                                           _mm_loadu_pd(gains + i))));
+#endif
+	for (; i < length; ++i)
+		x[i] += y[i] * gains[i];
+}
+void arrayAdd(real* const x, std::size_t length, real offset) noexcept
+{
+	std::size_t i = 0;
+#ifdef __SSE2__
+	__m128d const d = _mm_set1_pd(offset);
+	for (; i + 4 <= length; i += 4)
+	{
+		_mm_storeu_pd(x + i, _mm_add_pd(_mm_loadu_pd(x + i), d));
+		_mm_storeu_pd(x + i + 2, _mm_add_pd(_mm_loadu_pd(x + i + 2), d));
+	}
+#endif
+	for (; i < length; ++i)
+		x[i] += offset;
+}
+real arraySum(real const* const x, std::size_t length) noexcept
+{
+	std::size_t i = 0;
+	real sum = 0.0;
+#ifdef __SSE2__
+	// Two accumulators of two lanes hide the latency of the additions
+	__m128d s0 = _mm_setzero_pd();
+	__m128d s1 = _mm_setzero_pd();
+	for (; i + 4 <= length; i += 4)
+	{
+		s0 = _mm_add_pd(s0, _mm_loadu_pd(x + i));
+		s1 = _mm_add_pd(s1, _mm_loadu_pd(x + i + 2));
+	}
+	double lanes[2];
+	_mm_storeu_pd(lanes, _mm_add_pd(s0, s1));
+	sum = lanes[0] + lanes[1];
+#endif
+	for (; i < length; ++i)
+		sum += x[i];
+	return sum;
+}
+real arrayPeak(real const* const x, std::size_t length) noexcept
+{
+	std::size_t i = 0;
+	real peak = 0.0;
+#ifdef __SSE2__
+	// Clearing the sign bit gives the magnitude
+	__m128d const mask = _mm_castsi128_pd(_mm_set1_epi64x(0x7FFFFFFFFFFFFFFF));
+	__m128d p0 = _mm_setzero_pd();
+	__m128d p1 = _mm_setzero_pd();
+	for (; i + 4 <= length; i += 4)
+	{
+		p0 = _mm_max_pd(p0, _mm_and_pd(_mm_loadu_pd(x + i), mask));
+		p1 = _mm_max_pd(p1, _mm_and_pd(_mm_loadu_pd(x + i + 2), mask));
+	}
+	double lanes[2];
+	_mm_storeu_pd(lanes, _mm_max_pd(p0, p1));
+	peak = std::max(lanes[0], lanes[1]);
+#endif
+	for (; i < length; ++i)
+		peak = std::max(peak, std::abs(x[i]));
+	return peak;
+}
+void arrayPeaks(real* const peaks, real const* const x,
+                std::size_t length) noexcept
+{
+	std::size_t i = 0;
+#ifdef __SSE2__
+	__m128d const mask = _mm_castsi128_pd(_mm_set1_epi64x(0x7FFFFFFFFFFFFFFF));
+	for (; i + 2 <= length; i += 2)
+		_mm_storeu_pd(peaks + i, _mm_max_pd(_mm_loadu_pd(peaks + i),
+		                                    _mm_and_pd(_mm_loadu_pd(x + i), mask)));
+#endif
+	for (; i < length; ++i)
+		peaks[i] = std::max(peaks[i], std::abs(x[i]));
+}
+
+} // namespace pg
@@ -0,0 +1,57 @@
+#ifndef _POLYGAMMA_MATH_ARITHMETIC_HPP__
+#define _POLYGAMMA_MATH_ARITHMETIC_HPP__
+
+#include "../core/polygamma.hpp"
+
+namespace pg
+{
+
+/*
+ * Element-wise operations on arrays of samples. They are bound by memory
+ * bandwidth, so each is a single pass of SSE2 over the array with unaligned
+ * loads, with a scalar tail.
+ */
+
+/**
+ * @brief x[i] *= gain
+ */
+void arrayScale(real* const x, std::size_t length, real gain) noexcept;
+/**
+ * The gains are accumulated, so very long ramps should be split.
+ * @brief x[i] *= gain + i * increment
+ */
+void arrayRamp(real* const x, std::size_t length,
+               real gain, real increment) noexcept;
+/**
+ * @brief x[i] *= gains[i]
+ */
+void arrayMultiply(real* const x, real const* const gains,
+                   std::size_t length) noexcept;
+/**
+ * @brief x[i] += y[i] * gains[i]
+ */
+void arrayMultiplyAdd(real* const x, real const* const y,
+                      real const* const gains, std::size_t length) noexcept;
+/**
+ * @brief x[i] += offset
+ */
+void arrayAdd(real* const x, std::size_t length, real offset) noexcept;
+/**
+ * The order of the additions depends only on length, so the result is
+ * reproducible.
+ * @brief Sum of x[i].
+ */
+real arraySum(real const* const x, std::size_t length) noexcept;
+/**
+ * @brief Largest |x[i]|, 0 if length is 0.
+ */
+real arrayPeak(real const* const x, std::size_t length) noexcept;
+/**
+ * @brief peaks[i] = max(peaks[i], |x[i]|)
+ */
+void arrayPeaks(real* const peaks, real const* const x,
+                std::size_t length) noexcept;
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_ARITHMETIC_HPP__
@@ -0,0 +1,112 @@
+#include "biquad.hpp"
+
+#include <cassert>
+#include <cmath>
+
+namespace pg
+{
+
+/**
+ * @brief biquadNormalise Divides every coefficient by a0.
+ */
+biquad biquadNormalise(real b0, real b1, real b2,
+                       real a0, real a1, real a2) noexcept;
+
+
+// Implementations
+
+biquad biquadNormalise(real b0, real b1, real b2,
+                       real a0, real a1, real a2) noexcept
+{
+	real const inv = 1.0 / a0;
+	return biquad{b0 * inv, b1 * inv, b2 * inv, a1 * inv, a2 * inv};
+}
+
+biquad biquadLowPass(real frequency, real q, real sampleRate) noexcept
+{
+	real const w0 = 2 * M_PI * frequency / sampleRate;
+	real const cosW0 = std::cos(w0);
+	real const alpha = std::sin(w0) / (2 * q);
+	return biquadNormalise((1 - cosW0) * 0.5, 1 - cosW0, (1 - cosW0) * 0.5,
+	                       1 + alpha, -2 * cosW0, 1 - alpha);
+}
+biquad biquadHighPass(real frequency, real q, real sampleRate) noexcept
+{
+	real const w0 = 2 * M_PI * frequency / sampleRate;
+	real const cosW0 = std::cos(w0);
+	real const alpha = std::sin(w0) / (2 * q);
+	return biquadNormalise((1 + cosW0) * 0.5, -(1 + cosW0), (1 + cosW0) * 0.5,
+	                       1 + alpha, -2 * cosW0, 1 - alpha);
+}
+biquad biquadPeak(real frequency, real q, real gainDB,
+                  real sampleRate) noexcept
+{
+	real const a = std::pow(10.0, gainDB / 40);
+	real const w0 = 2 * M_PI * frequency / sampleRate;
+	real const cosW0 = std::cos(w0);
+	real const alpha = std::sin(w0) / (2 * q);
+	return biquadNormalise(1 + alpha * a, -2 * cosW0, 1 - alpha * a,
+	                       1 + alpha / a, -2 * cosW0, 1 - alpha / a);
+}
+biquad biquadLowShelf(real frequency, real q, real gainDB,
+                      real sampleRate) noexcept
+{
+	real const a = std::pow(10.0, gainDB / 40);
+	real const w0 = 2 * M_PI * frequency / sampleRate;
+	real const cosW0 = std::cos(w0);
+	real const beta = 2 * std::sqrt(a) * std::sin(w0) / (2 * q);
+	return biquadNormalise(a * ((a + 1) - (a - 1) * cosW0 + beta),
+	                       2 * a * ((a - 1) - (a + 1) * cosW0),
+	                       a * ((a + 1) - (a - 1) * cosW0 - beta),
+	                       (a + 1) + (a - 1) * cosW0 + beta,
+	                       -2 * ((a - 1) + (a + 1) * cosW0),
+	                       (a + 1) + (a - 1) * cosW0 - beta);
+}
+biquad biquadHighShelf(real frequency, real q, real gainDB,
+                       real sampleRate) noexcept
+{
+	real const a = std::pow(10.0, gainDB / 40);
+	real const w0 = 2 * M_PI * frequency / sampleRate;
+	real const cosW0 = std::cos(w0);
+	real const beta = 2 * std::sqrt(a) * std::sin(w0) / (2 * q);
+	return biquadNormalise(a * ((a + 1) + (a - 1) * cosW0 + beta),
+	                       -2 * a * ((a - 1) + (a + 1) * cosW0),
+	                       a * ((a + 1) + (a - 1) * cosW0 - beta),
+	                       (a + 1) - (a - 1) * cosW0 + beta,
+	                       2 * ((a - 1) - (a + 1) * cosW0),
+	                       (a + 1) - (a - 1) * cosW0 - beta);
+}
+
+bool biquadShape(biquad* const out, std::string const& shape,
+                 real frequency, real q, real gainDB, real sampleRate) noexcept
+{
+	if (shape == "lowpass")
+		*out = biquadLowPass(frequency, q, sampleRate);
+	else if (shape == "highpass")
+		*out = biquadHighPass(frequency, q, sampleRate);
+	else if (shape == "peak")
+		*out = biquadPeak(frequency, q, gainDB, sampleRate);
+	else if (shape == "lowshelf")
+		*out = biquadLowShelf(frequency, q, gainDB, sampleRate);
+	else if (shape == "highshelf")
+		*out = biquadHighShelf(frequency, q, gainDB, sampleRate);
+	else
+		return false;
+	return true;
+}
+std::vector<biquad> biquadButterworth(bool highPass, real frequency,
+                                      std::size_t order, real sampleRate)
+{
+	assert(order >= 2 && order % 2 == 0);
+	// The poles of section k lie at angles (2k - 1) pi / (2 order) from the axis
+	std::vector<biquad> sections;
+	for (std::size_t k = 1; k <= order / 2; ++k)
+	{
+		real const q = 1.0 / (2 * std::cos((2 * k - 1) * M_PI / (2 * order)));
+		sections.push_back(highPass ? biquadHighPass(frequency, q, sampleRate) :
+		                   biquadLowPass(frequency, q, sampleRate));
+	}
+	return sections;
+}
+
+} // namespace pg
@@ -0,0 +1,59 @@
+#ifndef _POLYGAMMA_MATH_BIQUAD_HPP__
+#define _POLYGAMMA_MATH_BIQUAD_HPP__
+
+#include <string>
+#include <vector>
+
+#include "../core/polygamma.hpp"
+
+namespace pg
+{
+
+/**
+ * Coefficients of a normalised (a0 = 1) second order section
+ *
+ * y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+ *
+ * @brief Coefficients of one biquad filter.
+ */
+struct biquad
+{
+	real b0, b1, b2;
+	real a1, a2;
+};
+
+/**
+ * @brief The biquad that leaves the signal untouched.
+ */
+constexpr biquad const BIQUAD_IDENTITY = {1.0, 0.0, 0.0, 0.0, 0.0};
+
+/*
+ * The following functions design biquads according to R. Bristow-Johnson's
+ * Audio EQ Cookbook. frequency is in Hz and must lie in ]0, sampleRate / 2[.
+ */
+biquad biquadLowPass(real frequency, real q, real sampleRate) noexcept;
+biquad biquadHighPass(real frequency, real q, real sampleRate) noexcept;
+biquad biquadPeak(real frequency, real q, real gainDB,
+                  real sampleRate) noexcept;
+biquad biquadLowShelf(real frequency, real q, real gainDB,
+                      real sampleRate) noexcept;
+biquad biquadHighShelf(real frequency, real q, real gainDB,
+                       real sampleRate) noexcept;
+/**
+ * @brief Designs a biquad by the name of its shape: "lowpass", "highpass",
+ *  "peak", "lowshelf" or "highshelf".
+ * @return false if the shape is unknown.
+ */
+bool biquadShape(biquad* const out, std::string const& shape,
+                 real frequency, real q, real gainDB, real sampleRate) noexcept;
+/**
+ * @brief Designs a Butterworth low or high pass of the given even order as
+ *  order / 2 cascaded sections.
+ */
+std::vector<biquad> biquadButterworth(bool highPass, real frequency,
+                                      std::size_t order,
+                                      real sampleRate);
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_BIQUAD_HPP__
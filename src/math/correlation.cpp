@@ -0,0 +1,226 @@
+#include "correlation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "ThreadPool.hpp"
+#include "fourier.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace pg
+{
+
+/**
+ * Samples outside [0, length[ count as silence. If D > 1, block j is the mean
+ * of |sum of the channels| over the samples begin + j * D + i for i < D, and
+ * the mean of the blocks which overlap the signal is subtracted from them.
+ * @brief Features of count blocks of D samples of the sum of the channels,
+ *  from sample begin: the waveform if D is 1, the envelope otherwise.
+ */
+std::vector<real> alignFeatures(real const* const* const x,
+                                std::size_t nChannels, std::size_t length,
+                                std::ptrdiff_t begin, std::size_t count,
+                                std::size_t D);
+
+
+// Implementations
+
+std::vector<real> alignFeatures(real const* const* const x,
+                                std::size_t nChannels, std::size_t length,
+                                std::ptrdiff_t begin, std::size_t count,
+                                std::size_t D)
+{
+	std::vector<real> features(count, 0.0);
+	std::ptrdiff_t const end = length;
+	constexpr std::size_t CHUNK = 1 << 12;
+	ThreadPool::get().run((count + CHUNK - 1) / CHUNK, [&](std::size_t chunk)
+	{
+		std::size_t const last = std::min(count, (chunk + 1) * CHUNK);
+		for (std::size_t j = chunk * CHUNK; j < last; ++j)
+		{
+			std::ptrdiff_t const first = begin + (std::ptrdiff_t) (j * D);
+			std::ptrdiff_t const from = std::max<std::ptrdiff_t>(first, 0);
+			std::ptrdiff_t const to = std::min<std::ptrdiff_t>(first + D, end);
+			std::ptrdiff_t s = from;
+			real sum = 0.0;
+#ifdef __SSE2__
+			static_assert(sizeof(real) == sizeof(double),
+			              "The SSE2 path assumes double precision");
+			__m128d const mask = _mm_castsi128_pd(_mm_set1_epi64x(D == 1 ? -1 :
+			                                      0x7fffffffffffffffLL));
+			__m128d acc = _mm_setzero_pd();
+			for (; s + 2 <= to; s += 2)
+			{
+				__m128d v = _mm_loadu_pd(x[0] + s);
+				for (std::size_t c = 1; c < nChannels; ++c)
+					v = _mm_add_pd(v, _mm_loadu_pd(x[c] + s));
+				acc = _mm_add_pd(acc, _mm_and_pd(v, mask));
+			}
+			double lanes[2];
+			_mm_storeu_pd(lanes, acc);
+			sum = lanes[0] + lanes[1];
+#endif
+			for (; s < to; ++s)
+			{
+				real v = 0.0;
+				for (std::size_t c = 0; c < nChannels; ++c)
+					v += x[c][s];
+				sum += D == 1 ? v : std::abs(v);
+			}
+			features[j] = D == 1 ? sum : sum / D;
+		}
+	});
+	if (D == 1)
+		return features;
+
+	// Blocks overlapping [0, length[
+	std::ptrdiff_t const step = D;
+	std::size_t const from = begin >= 0 ? 0 :
+	                         std::min<std::size_t>(-begin / step, count);
+	std::size_t const to = begin >= end ? 0 :
+	                       std::min<std::size_t>((end - begin + step - 1) / step,
+	                                             count);
+	if (from >= to)
+		return features;
+	real mean = 0.0;
+	for (std::size_t j = from; j < to; ++j)
+		mean += features[j];
+	mean /= to - from;
+	for (std::size_t j = from; j < to; ++j)
+		features[j] -= mean;
+	return features;
+}
+
+void crossCorrelate(real* const out,
+                    real const* const a, std::size_t lengthA,
+                    real const* const b, std::size_t lengthB,
+                    std::size_t nLags)
+{
+	// Lag k of sample i reads b[i + k] < lengthA + nLags, which must not wrap
+	std::size_t const n = dftLength(std::max(lengthB, lengthA + nLags - 1));
+	std::vector<real> signal(n, 0.0);
+	std::vector<complex> spectrumA(n / 2 + 1), spectrumB(n / 2 + 1);
+	std::copy(a, a + lengthA, signal.begin());
+	dftReal(spectrumA.data(), signal.data(), n);
+	std::fill(signal.begin(), signal.end(), 0.0);
+	std::copy(b, b + lengthB, signal.begin());
+	dftReal(spectrumB.data(), signal.data(), n);
+	for (std::size_t k = 0; k <= n / 2; ++k)
+		spectrumB[k] *= std::conj(spectrumA[k]);
+	idftReal(signal.data(), spectrumB.data(), n);
+	std::copy(signal.begin(), signal.begin() + std::min(nLags, n), out);
+	std::fill(out + std::min(nLags, n), out + nLags, 0.0);
+}
+
+Alignment align(real const* const* const a, std::size_t nChannelsA,
+                std::size_t lengthA,
+                real const* const* const b, std::size_t nChannelsB,
+                std::size_t lengthB, std::size_t maxLag)
+{
+	if (lengthA == 0 || lengthB == 0)
+		return Alignment{0, 0.0};
+	std::ptrdiff_t const M = maxLag;
+
+	std::size_t D = 1;
+	while ((lengthA + 2 * maxLag) / D > ALIGN_COARSE_MAX)
+		D *= 2;
+	std::size_t const coarse = D;
+	std::vector<real> envelope; // Of a at the coarsest level
+
+	// The coarsest level takes the whole of a as its only window
+	std::ptrdiff_t lo = -M, hi = M;
+	std::vector<std::size_t> starts(1, 0);
+	std::size_t span = lengthA;
+	while (true)
+	{
+		std::size_t const count = (span + D - 1) / D;
+		std::size_t const nLags = (hi - lo) / D + 1;
+		std::vector<std::vector<real>> correlations(starts.size());
+		std::vector<std::vector<real>> featuresA(starts.size());
+		std::vector<std::vector<real>> featuresB(starts.size());
+		auto const correlate = [&](std::size_t w)
+		{
+			std::ptrdiff_t const start = starts[w];
+			featuresA[w] = alignFeatures(a, nChannelsA, lengthA, start, count, D);
+			featuresB[w] = alignFeatures(b, nChannelsB, lengthB, start + lo,
+			                             count + nLags - 1, D);
+			correlations[w].resize(nLags);
+			crossCorrelate(correlations[w].data(), featuresA[w].data(), count,
+			               featuresB[w].data(), featuresB[w].size(), nLags);
+		};
+		// A single window is parallel within, several are parallel between
+		if (starts.size() == 1)
+			correlate(0);
+		else
+			ThreadPool::get().run(starts.size(), correlate);
+
+		// Windows are summed in order, which keeps the result deterministic
+		std::size_t best = 0;
+		real bestValue = -std::numeric_limits<real>::infinity();
+		for (std::size_t k = 0; k < nLags; ++k)
+		{
+			real value = 0.0;
+			for (auto const& c: correlations)
+				value += c[k];
+			if (value > bestValue)
+			{
+				bestValue = value;
+				best = k;
+			}
+		}
+		std::ptrdiff_t const centre = lo + (std::ptrdiff_t) (best * D);
+
+		if (D == 1)
+		{
+			real energyA = 0.0, energyB = 0.0;
+			for (std::size_t w = 0; w < starts.size(); ++w)
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					energyA += featuresA[w][i] * featuresA[w][i];
+					real const y = featuresB[w][i + best];
+					energyB += y * y;
+				}
+			real const confidence = energyA > 0.0 && energyB > 0.0 ?
+			                        bestValue / std::sqrt(energyA * energyB) : 0.0;
+			return Alignment{centre, std::min(1.0, std::max(0.0, confidence))};
+		}
+		if (D == coarse)
+			envelope = std::move(featuresA[0]);
+
+		// Two blocks of this level on either side of its best lag
+		lo = std::max(-M, centre - 2 * (std::ptrdiff_t) D);
+		hi = std::min(M, centre + 2 * (std::ptrdiff_t) D);
+		D = std::max<std::size_t>(D / ALIGN_STEP, 1);
+
+		// Windows where the envelope of a varies the most, preferably within b
+		span = std::min(lengthA, ALIGN_WINDOW * D);
+		std::vector<std::pair<real, std::size_t>> candidates;
+		for (int inside = 1; inside >= 0 && candidates.empty(); --inside)
+			for (std::size_t start = 0; start + span <= lengthA; start += span)
+			{
+				std::ptrdiff_t const s = start;
+				if (inside && (s + lo < 0 || s + (std::ptrdiff_t) span + hi >
+				               (std::ptrdiff_t) lengthB))
+					continue;
+				std::size_t const last = std::min(envelope.size(),
+				                                  (start + span) / coarse + 1);
+				real score = 0.0;
+				for (std::size_t j = start / coarse; j < last; ++j)
+					score += envelope[j] * envelope[j];
+				candidates.emplace_back(-score, start);
+			}
+		std::size_t const nWindows = std::min(ALIGN_WINDOWS, candidates.size());
+		std::partial_sort(candidates.begin(), candidates.begin() + nWindows,
+		                  candidates.end());
+		starts.resize(nWindows);
+		for (std::size_t w = 0; w < nWindows; ++w)
+			starts[w] = candidates[w].second;
+	}
+}
+
+} // namespace pg
@@ -0,0 +1,65 @@
+#ifndef _POLYGAMMA_MATH_CORRELATION_HPP__
+#define _POLYGAMMA_MATH_CORRELATION_HPP__
+
+#include <cstddef>
+
+#include "../core/polygamma.hpp"
+
+namespace pg
+{
+
+/**
+ * @brief Offset between two signals, see align.
+ */
+struct Alignment
+{
+	std::ptrdiff_t offset; // a[i] matches b[i + offset]
+	/*
+	 * Normalised cross-correlation of the matched parts at full rate, from 0
+	 * (unrelated) to 1 (identical up to a gain).
+	 */
+	real confidence;
+};
+
+/**
+ * The transform is done with dftReal at the smallest length with prime
+ * factors 2, 3 and 5 that avoids wrapping around.
+ * @brief Cross-correlation out[k] = sum over i of a[i] * b[i + k] for
+ *  0 <= k < nLags, with the signals padded by zeroes.
+ * @param[out] out nLags values.
+ */
+void crossCorrelate(real* const out,
+                    real const* const a, std::size_t lengthA,
+                    real const* const b, std::size_t lengthB,
+                    std::size_t nLags);
+/**
+ * The channels of each signal are summed. A correlation over the whole range
+ * of lags at full rate would cost an FFT longer than both signals, so the
+ * search narrows down over several levels instead:
+ * - The coarsest level correlates the amplitude envelopes, averaged over
+ *   blocks of a power of 2 samples such that at most ALIGN_COARSE_MAX blocks
+ *   cover a, over all the lags.
+ * - Each finer level decimates ALIGN_STEP times less and searches two blocks
+ *   of the previous level around its best lag, correlating only the
+ *   ALIGN_WINDOWS windows of ALIGN_WINDOW blocks where the envelope of a
+ *   varies the most. Windows are correlated in parallel.
+ * - The last level correlates the waveforms in these windows.
+ * The search therefore reads both signals once and then only touches small
+ * windows.
+ * @brief Finds the offset within [-maxLag, maxLag] which best matches a with
+ *  b.
+ * @param[in] a, b Planar channels of lengthA and lengthB samples.
+ */
+Alignment align(real const* const* const a, std::size_t nChannelsA,
+                std::size_t lengthA,
+                real const* const* const b, std::size_t nChannelsB,
+                std::size_t lengthB, std::size_t maxLag);
+
+constexpr std::size_t ALIGN_COARSE_MAX = 1 << 19;
+constexpr std::size_t ALIGN_STEP = 32;
+constexpr std::size_t ALIGN_WINDOW = 1 << 13;
+constexpr std::size_t ALIGN_WINDOWS = 8;
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_CORRELATION_HPP__
@@ -0,0 +1,122 @@
+#include "curve.hpp"
+
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace pg
+{
+
+/**
+ * @brief The value of CurveExponential at t = 0 before it is offset.
+ */
+real curveExponentialFloor() noexcept;
+
+
+// Implementations
+
+inline real curveExponentialFloor() noexcept
+{
+	return std::pow(10.0, -CURVE_EXPONENTIAL_RANGE / 20);
+}
+
+bool curveParse(CurveType* const out, std::string const& name) noexcept
+{
+	if (name == "linear")
+		*out = CurveLinear;
+	else if (name == "sine")
+		*out = CurveSine;
+	else if (name == "scurve")
+		*out = CurveSCurve;
+	else if (name == "exponential")
+		*out = CurveExponential;
+	else
+		return false;
+	return true;
+}
+real curveValue(CurveType type, real t) noexcept
+{
+	switch (type)
+	{
+	case CurveSine:
+		return std::sin(M_PI_2 * t);
+	case CurveSCurve:
+		return 0.5 - 0.5 * std::cos(M_PI * t);
+	case CurveExponential:
+	{
+		real const floor = curveExponentialFloor();
+		return (std::pow(10.0, CURVE_EXPONENTIAL_RANGE * (t - 1) / 20) - floor) /
+		       (1 - floor);
+	}
+	default:
+		return t;
+	}
+}
+
+void curveRender(real* const out, std::size_t length, CurveType type,
+                 real t0, real dt) noexcept
+{
+	std::size_t i = 0;
+#ifdef __SSE2__
+	static_assert(sizeof(real) == sizeof(double),
+	              "The SSE2 path assumes double precision");
+	// Lane 0 holds the sample i, lane 1 the sample i + 1
+	switch (type)
+	{
+	case CurveLinear:
+	{
+		__m128d t = _mm_set_pd(t0 + dt, t0);
+		__m128d const step = _mm_set1_pd(2 * dt);
+		for (; i + 2 <= length; i += 2)
+		{
+			_mm_storeu_pd(out + i, t);
+			t = _mm_add_pd(t, step);
+		}
+		break;
+	}
+	case CurveSine:
+	case CurveSCurve:
+	{
+		// Rotates the phasor (cos, sin) of the angle by twice the increment
+		real const k = type == CurveSine ? M_PI_2 : M_PI;
+		real const delta = k * dt;
+		__m128d c = _mm_set_pd(std::cos(k * t0 + delta), std::cos(k * t0));
+		__m128d s = _mm_set_pd(std::sin(k * t0 + delta), std::sin(k * t0));
+		__m128d const rc = _mm_set1_pd(std::cos(2 * delta));
+		__m128d const rs = _mm_set1_pd(std::sin(2 * delta));
+		__m128d const half = _mm_set1_pd(0.5);
+		for (; i + 2 <= length; i += 2)
+		{
+			_mm_storeu_pd(out + i, type == CurveSine ? s :
+			              _mm_sub_pd(half, _mm_mul_pd(half, c)));
+			__m128d const cNext = _mm_sub_pd(_mm_mul_pd(c, rc), _mm_mul_pd(s, rs));
+			s = _mm_add_pd(_mm_mul_pd(s, rc), _mm_mul_pd(c, rs));
+			c = cNext;
+		}
+		break;
+	}
+	case CurveExponential:
+	{
+		real const floor = curveExponentialFloor();
+		real const e0 = std::pow(10.0, CURVE_EXPONENTIAL_RANGE * (t0 - 1) / 20);
+		real const ratio = std::pow(10.0, CURVE_EXPONENTIAL_RANGE * dt / 20);
+		__m128d e = _mm_set_pd(e0 * ratio, e0);
+		__m128d const r = _mm_set1_pd(ratio * ratio);
+		__m128d const offset = _mm_set1_pd(floor);
+		__m128d const scale = _mm_set1_pd(1 / (1 - floor));
+		for (; i + 2 <= length; i += 2)
+		{
+			_mm_storeu_pd(out + i, _mm_mul_pd(_mm_sub_pd(e, offset), scale));
+			e = _mm_mul_pd(e, r);
+		}
+		break;
+	}
+	}
+#endif
+	for (; i < length; ++i)
+		out[i] = curveValue(type, t0 + i * dt);
+}
+
+} // namespace pg
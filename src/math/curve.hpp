@@ -0,0 +1,51 @@
+#ifndef _POLYGAMMA_MATH_CURVE_HPP__
+#define _POLYGAMMA_MATH_CURVE_HPP__
+
+#include <string>
+
+#include "../core/polygamma.hpp"
+
+namespace pg
+{
+
+/**
+ * Every curve rises from 0 at t = 0 to 1 at t = 1. A fade out is the curve
+ * traversed backwards, so a pair of fades of the same type is symmetric.
+ */
+enum CurveType
+{
+	CurveLinear, // t
+	CurveSine, // sin(pi t / 2). Equal power crossfades
+	CurveSCurve, // (1 - cos(pi t)) / 2
+	CurveExponential // Linear in decibels over CURVE_EXPONENTIAL_RANGE
+};
+
+/**
+ * @brief Range in dB of CurveExponential. The curve is offset and scaled so
+ *  that it starts at 0 instead of -CURVE_EXPONENTIAL_RANGE dB.
+ */
+constexpr real CURVE_EXPONENTIAL_RANGE = 60.0;
+
+/**
+ * @brief Obtains the curve by its name: "linear", "sine", "scurve" or
+ *  "exponential".
+ * @return false if the name is unknown.
+ */
+bool curveParse(CurveType* const out, std::string const& name) noexcept;
+/**
+ * @brief Evaluates the curve at t in [0, 1].
+ */
+real curveValue(CurveType, real t) noexcept;
+/**
+ * With SSE2 no transcendental function is evaluated per sample: the sine
+ * curves rotate a phasor and the exponential one multiplies by a constant
+ * ratio, two samples at a time. t0 + i dt must lie in [0, 1] for
+ * i < length, and dt may be negative.
+ * @brief Renders the curve at t0 + i dt for i < length into out.
+ */
+void curveRender(real* const out, std::size_t length, CurveType,
+                 real t0, real dt) noexcept;
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_CURVE_HPP__
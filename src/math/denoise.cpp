@@ -0,0 +1,165 @@
+#include "denoise.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "ThreadPool.hpp"
+#include "fourier.hpp"
+#include "window.hpp"
+
+namespace pg
+{
+
+// Implementations
+
+NoiseProfile noiseProfile(real const* const* const signals,
+                          std::size_t const* const lengths,
+                          std::size_t nSignals, real sampleRate)
+{
+	std::size_t const windowLength = DENOISE_WINDOW;
+	std::size_t const hop = windowLength / 4;
+	std::size_t const nBins = windowLength / 2 + 1;
+	real const* const analysis = window(WindowHann, windowLength);
+
+	NoiseProfile profile{sampleRate, windowLength,
+	                     std::vector<real>(nBins, 0.0), 0};
+	std::vector<complex> spectrogram(DENOISE_CHUNK * nBins);
+	for (std::size_t i = 0; i < nSignals; ++i)
+	{
+		std::size_t const nFrames = lengths[i] ? dstftFrames(lengths[i], hop) : 0;
+		for (std::size_t start = 0; start < nFrames; start += DENOISE_CHUNK)
+		{
+			std::size_t const end = std::min(nFrames, start + DENOISE_CHUNK);
+			dstft(spectrogram.data(), signals[i], lengths[i], analysis,
+			      windowLength, hop, start, end);
+			for (std::size_t f = 0; f < end - start; ++f)
+				for (std::size_t k = 0; k < nBins; ++k)
+					profile.magnitude[k] += std::abs(spectrogram[f * nBins + k]);
+		}
+		profile.nFrames += nFrames;
+	}
+	if (profile.nFrames)
+		for (auto& m: profile.magnitude)
+			m /= profile.nFrames;
+	return profile;
+}
+
+void denoise(real* const signal, std::size_t length,
+             NoiseProfile const& profile, real thresholdDB, real reductionDB,
+             std::size_t smoothBins, std::size_t smoothFrames)
+{
+	std::size_t const windowLength = profile.windowLength;
+	std::size_t const hop = windowLength / 4;
+	std::size_t const nBins = windowLength / 2 + 1;
+	real const* const analysis = window(WindowHann, windowLength);
+	real const* const synthesis = windowSynthesis(WindowHann, windowLength, hop);
+	std::size_t const nFrames = dstftFrames(length, hop);
+
+	// Frames reaching a sample on either side, and those smoothed into a frame
+	std::size_t const W = (windowLength / 2 + hop - 1) / hop;
+	std::size_t const T = smoothFrames;
+	// The next chunk reads its input only after this one has been written
+	assert(DENOISE_CHUNK >= 2 * (W + T));
+
+	std::vector<real> thresholds(nBins); // Squared magnitudes
+	real const ratio = std::pow(10.0, thresholdDB / 20);
+	for (std::size_t k = 0; k < nBins; ++k)
+		thresholds[k] = profile.magnitude[k] * ratio * profile.magnitude[k] * ratio;
+	real const floor = std::pow(10.0, -reductionDB / 20);
+
+	std::size_t const capacity = DENOISE_CHUNK + 2 * (W + T);
+	std::vector<real> input((capacity + 2 * W) * hop);
+	std::vector<real> output(input.size());
+	std::vector<complex> spectrogram(capacity * nBins);
+	std::vector<real> gains(capacity * nBins);
+	std::vector<real> pending(DENOISE_CHUNK * hop);
+	std::size_t pendingBegin = 0, pendingLength = 0;
+
+	for (std::size_t start = 0; start < nFrames; start += DENOISE_CHUNK)
+	{
+		std::size_t const end = std::min(nFrames, start + DENOISE_CHUNK);
+		// Frames synthesised, and frames analysed for their gains
+		std::size_t const b0 = start > W ? start - W : 0;
+		std::size_t const b1 = std::min(nFrames, end + W);
+		std::size_t const a0 = b0 > T ? b0 - T : 0;
+		std::size_t const a1 = std::min(nFrames, b1 + T);
+		std::size_t const n = a1 - a0;
+
+		// Frame a0 is centred on sample W hop of the local signal
+		std::size_t const nLocal = (n + 2 * W) * hop;
+		std::ptrdiff_t const base = (std::ptrdiff_t) (a0 * hop) -
+		                            (std::ptrdiff_t) (W * hop);
+		for (std::size_t i = 0; i < nLocal; ++i)
+		{
+			std::ptrdiff_t const s = base + (std::ptrdiff_t) i;
+			input[i] = s >= 0 && s < (std::ptrdiff_t) length ? signal[s] : 0.0;
+		}
+		std::copy(pending.begin(), pending.begin() + pendingLength,
+		          signal + pendingBegin);
+
+		dstft(spectrogram.data(), input.data(), nLocal, analysis, windowLength,
+		      hop, W, W + n);
+
+		// Gate every bin, then average the gains along frequency
+		ThreadPool::get().run(n, [&](std::size_t f)
+		{
+			complex const* const row = &spectrogram[f * nBins];
+			real* const g = &gains[f * nBins];
+			std::vector<real> gate(nBins);
+			for (std::size_t k = 0; k < nBins; ++k)
+				gate[k] = std::norm(row[k]) > thresholds[k] ? 1.0 : floor;
+			real sum = 0.0;
+			std::size_t const F = smoothBins;
+			for (std::size_t k = 0; k < std::min(F, nBins); ++k)
+				sum += gate[k];
+			for (std::size_t k = 0; k < nBins; ++k)
+			{
+				if (k + F < nBins)
+					sum += gate[k + F];
+				if (k > F)
+					sum -= gate[k - F - 1];
+				std::size_t const count = std::min(nBins, k + F + 1) -
+				                          (k > F ? k - F : 0);
+				g[k] = sum / count;
+			}
+		});
+
+		// Average along time and apply to the synthesised frames
+		constexpr std::size_t COLUMNS = 64;
+		ThreadPool::get().run((nBins + COLUMNS - 1) / COLUMNS, [&](std::size_t c)
+		{
+			std::size_t const k0 = c * COLUMNS;
+			std::size_t const k1 = std::min(nBins, k0 + COLUMNS);
+			real sums[COLUMNS] = {};
+			// The rows [from, to[ are summed
+			std::size_t from = 0, to = 0;
+			for (std::size_t f = b0 - a0; f < b1 - a0; ++f)
+			{
+				for (; to < std::min(n, f + T + 1); ++to)
+					for (std::size_t k = k0; k < k1; ++k)
+						sums[k - k0] += gains[to * nBins + k];
+				for (; from + T < f; ++from)
+					for (std::size_t k = k0; k < k1; ++k)
+						sums[k - k0] -= gains[from * nBins + k];
+				real const count = to - from;
+				for (std::size_t k = k0; k < k1; ++k)
+					spectrogram[f * nBins + k] *= sums[k - k0] / count;
+			}
+		});
+
+		idstft(output.data(), nLocal, &spectrogram[(b0 - a0) * nBins],
+		       analysis, synthesis, windowLength, hop, W + b0 - a0, W + b1 - a0);
+
+		// The last frame may be centred past the end
+		pendingBegin = std::min(start * hop, length);
+		pendingLength = std::min(end * hop, length) - pendingBegin;
+		std::copy(output.begin() + (pendingBegin - base),
+		          output.begin() + (pendingBegin - base + pendingLength),
+		          pending.begin());
+	}
+	std::copy(pending.begin(), pending.begin() + pendingLength,
+	          signal + pendingBegin);
+}
+
+} // namespace pg
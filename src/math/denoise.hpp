@@ -0,0 +1,58 @@
+#ifndef _POLYGAMMA_MATH_DENOISE_HPP__
+#define _POLYGAMMA_MATH_DENOISE_HPP__
+
+#include <vector>
+
+#include "../core/polygamma.hpp"
+
+namespace pg
+{
+
+/**
+ * @brief Mean magnitude spectrum of a noise, see denoise.
+ */
+struct NoiseProfile
+{
+	real sampleRate;
+	std::size_t windowLength;
+	std::vector<real> magnitude; // windowLength / 2 + 1 bins
+	std::size_t nFrames; // Frames averaged
+};
+
+/**
+ * The Hann window of the short-time Fourier transforms, at a hop of a
+ * quarter of it.
+ */
+constexpr std::size_t DENOISE_WINDOW = 2048;
+/**
+ * Frames transformed at once. The memory of denoise depends on this and not
+ * on the length of the signal.
+ */
+constexpr std::size_t DENOISE_CHUNK = 512;
+
+/**
+ * @brief Measures the mean magnitude spectrum of nSignals signals of noise.
+ * @param[in] lengths Length of every signal.
+ */
+NoiseProfile noiseProfile(real const* const* const signals,
+                          std::size_t const* const lengths,
+                          std::size_t nSignals, real sampleRate);
+/**
+ * Bins louder than the profile by thresholdDB pass, the others are
+ * attenuated by reductionDB. The gains are then averaged over smoothBins
+ * bins and smoothFrames frames on either side, which softens the gate and
+ * suppresses the isolated bins of musical noise.
+ *
+ * The signal is processed DENOISE_CHUNK frames at a time. Each chunk is
+ * analysed with the frames its gains and its samples depend on, so the
+ * result does not depend on the chunking, and the frames of a chunk are
+ * transformed in parallel by dstft and idstft.
+ * @brief Spectral gating of a signal in place.
+ */
+void denoise(real* const signal, std::size_t length,
+             NoiseProfile const& profile, real thresholdDB, real reductionDB,
+             std::size_t smoothBins, std::size_t smoothFrames);
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_DENOISE_HPP__
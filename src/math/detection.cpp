@@ -0,0 +1,267 @@
+#include "detection.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "FFTPlan.hpp"
+#include "ThreadPool.hpp"
+#include "fourier.hpp"
+#include "window.hpp"
+
+namespace pg
+{
+
+// Implementations
+
+std::vector<Interval<std::size_t>> detectSilence(
+  real const* const* const channels, std::size_t nChannels,
+  std::size_t length, real threshold, std::size_t minLength)
+{
+	std::size_t const nBlocks = (length + SILENCE_BLOCK - 1) / SILENCE_BLOCK;
+	std::vector<std::vector<Interval<std::size_t>>> blocks(nBlocks);
+	ThreadPool::get().run(nBlocks, [&](std::size_t b)
+	{
+		std::size_t const begin = b * SILENCE_BLOCK;
+		std::size_t const end = std::min(length, begin + SILENCE_BLOCK);
+		std::vector<Interval<std::size_t>>& runs = blocks[b];
+		// Short runs may only grow into the neighbouring blocks
+		auto const close = [&](std::size_t first, std::size_t last)
+		{
+			if (last - first >= minLength || first == begin || last == end)
+				runs.emplace_back(first, last);
+		};
+
+		// The loudest channel of every sample, a slice at a time
+		constexpr std::size_t SLICE = 1024;
+		real peaks[SLICE];
+		std::size_t first = begin;
+		bool silent = false;
+		for (std::size_t i = begin; i < end; i += SLICE)
+		{
+			std::size_t const n = std::min(SLICE, end - i);
+			std::fill(peaks, peaks + n, 0.0);
+			for (std::size_t c = 0; c < nChannels; ++c)
+			{
+				real const* const x = channels[c] + i;
+				for (std::size_t j = 0; j < n; ++j)
+					peaks[j] = std::max(peaks[j], std::abs(x[j]));
+			}
+			for (std::size_t j = 0; j < n; ++j)
+			{
+				bool const quiet = peaks[j] <= threshold;
+				if (quiet && !silent)
+					first = i + j;
+				else if (!quiet && silent)
+					close(first, i + j);
+				silent = quiet;
+			}
+		}
+		if (silent)
+			close(first, end);
+	});
+
+	std::vector<Interval<std::size_t>> silences;
+	for (auto const& runs: blocks)
+		for (auto const& run: runs)
+		{
+			if (!silences.empty() && silences.back().end == run.begin)
+				silences.back().end = run.end;
+			else
+			{
+				if (!silences.empty() &&
+				    silences.back().end - silences.back().begin < minLength)
+					silences.pop_back();
+				silences.push_back(run);
+			}
+		}
+	if (!silences.empty() &&
+	    silences.back().end - silences.back().begin < minLength)
+		silences.pop_back();
+	return silences;
+}
+
+std::vector<std::size_t> detectOnsets(real const* const* const channels,
+                                      std::size_t nChannels,
+                                      std::size_t length, real sampleRate,
+                                      real threshold, std::size_t minDistance)
+{
+	std::size_t windowLength = 2;
+	while (2 * windowLength <= ONSET_WINDOW * sampleRate)
+		windowLength *= 2;
+	std::size_t const hop = windowLength / 2;
+	std::size_t const nBins = windowLength / 2 + 1;
+	real const* const analysis = window(WindowHann, windowLength);
+	// A full scale sinusoid peaks at 1, and -40 dB at about log 2
+	real const scale = 4.0 / windowLength * 100.0;
+
+	std::size_t const nFrames = length ? dstftFrames(length, hop) : 0;
+	std::size_t const nChunks = (nFrames + DETECTION_CHUNK - 1) / DETECTION_CHUNK;
+	std::vector<real> flux(nChannels * nFrames);
+	// Every task compares a chunk of frames of a channel with the frame before
+	ThreadPool::get().run(nChannels * nChunks, [&](std::size_t task)
+	{
+		std::size_t const c = task / nChunks;
+		std::size_t const start = task % nChunks * DETECTION_CHUNK;
+		std::size_t const end = std::min(nFrames, start + DETECTION_CHUNK);
+		std::size_t const first = start ? start - 1 : 0;
+		std::vector<complex> spectrogram((end - first) * nBins);
+		dstft(spectrogram.data(), channels[c], length, analysis, windowLength,
+		      hop, first, end);
+
+		std::vector<real> previous(nBins, 0.0), current(nBins);
+		for (std::size_t f = first; f < end; ++f)
+		{
+			complex const* const row = &spectrogram[(f - first) * nBins];
+			real sum = 0.0;
+			for (std::size_t k = 0; k < nBins; ++k)
+			{
+				current[k] = std::log1p(std::abs(row[k]) * scale);
+				sum += std::max(current[k] - previous[k], 0.0);
+			}
+			if (f >= start)
+				flux[c * nFrames + f] = sum;
+			std::swap(previous, current);
+		}
+	});
+
+	std::vector<real> odf(flux.begin(), flux.begin() + nFrames);
+	for (std::size_t c = 1; c < nChannels; ++c)
+		for (std::size_t f = 0; f < nFrames; ++f)
+			odf[f] += flux[c * nFrames + f];
+	real mean = 0.0, deviation = 0.0;
+	for (auto v: odf)
+		mean += v;
+	mean /= std::max<std::size_t>(nFrames, 1);
+	for (auto v: odf)
+		deviation += (v - mean) * (v - mean);
+	deviation = std::sqrt(deviation / std::max<std::size_t>(nFrames, 1));
+	std::vector<std::size_t> onsets;
+	if (!(deviation > 0.0))
+		return onsets;
+	for (auto& v: odf)
+		v = (v - mean) / deviation;
+
+	// The frames [from, to[ are summed for the local mean
+	std::size_t const R = ONSET_RADIUS;
+	real sum = 0.0;
+	std::size_t from = 0, to = 0;
+	for (std::size_t f = 0; f < nFrames; ++f)
+	{
+		for (; to < std::min(nFrames, f + R + 1); ++to)
+			sum += odf[to];
+		for (; from + ONSET_HISTORY < f; ++from)
+			sum -= odf[from];
+		if (odf[f] < sum / (to - from) + threshold)
+			continue;
+		// Plateaus count once, at their first frame
+		bool maximum = true;
+		for (std::size_t g = f > R ? f - R : 0; g < to && maximum; ++g)
+			maximum = g < f ? odf[g] < odf[f] : odf[g] <= odf[f];
+		std::size_t const position = f * hop;
+		if (maximum && (onsets.empty() || position - onsets.back() >= minDistance))
+			onsets.push_back(position);
+	}
+	return onsets;
+}
+
+Pitch detectPitch(real const* const* const channels, std::size_t nChannels,
+                  std::size_t length, real sampleRate, real minFrequency,
+                  real maxFrequency, real threshold)
+{
+	Pitch pitch;
+	pitch.hop = std::max<long>(1, std::lround(sampleRate * PITCH_HOP));
+	std::size_t const hop = pitch.hop;
+	std::size_t const nFrames = length ? dstftFrames(length, hop) : 0;
+	pitch.frequencies.resize(nFrames);
+
+	// Periods in [tauMin, tauMax[, with a neighbour on either side
+	std::size_t const tauMin = std::max<std::size_t>(
+	                             std::floor(sampleRate / maxFrequency), 2);
+	std::size_t const tauMax = std::max<std::size_t>(
+	                             std::ceil(sampleRate / minFrequency), tauMin) + 2;
+	// The difference function integrates over W samples
+	std::size_t const W = tauMax;
+	std::size_t const span = W + tauMax;
+	std::size_t const N = dftLength(span);
+	std::size_t const nBins = N / 2 + 1;
+	FFTPlan<real> const& forward = FFTPlan<real>::get(N, FFTPlan<real>::Forward);
+	FFTPlan<real> const& inverse = FFTPlan<real>::get(N, FFTPlan<real>::Inverse);
+
+	std::size_t const nChunks = (nFrames + DETECTION_CHUNK - 1) / DETECTION_CHUNK;
+	ThreadPool::get().run(nChunks, [&](std::size_t chunk)
+	{
+		std::size_t const start = chunk * DETECTION_CHUNK;
+		std::size_t const end = std::min(nFrames, start + DETECTION_CHUNK);
+		std::vector<real> a(N, 0.0), b(N, 0.0), energy(span + 1), d(tauMax);
+		std::vector<complex> A(nBins), B(nBins);
+		for (std::size_t f = start; f < end; ++f)
+		{
+			std::ptrdiff_t const offset = (std::ptrdiff_t) (f * hop) -
+			                              (std::ptrdiff_t) (span / 2);
+			std::fill(b.begin(), b.end(), 0.0);
+			// The last frames start past the end when the hop exceeds span / 2
+			std::size_t const jMin = offset < 0 ? -offset : 0;
+			std::size_t const jMax = (std::size_t) std::max<std::ptrdiff_t>(
+			                           jMin, std::min<std::ptrdiff_t>(
+			                             span, (std::ptrdiff_t) length - offset));
+			for (std::size_t c = 0; c < nChannels; ++c)
+				for (std::size_t j = jMin; j < jMax; ++j)
+					b[j] += channels[c][offset + j];
+			std::copy(b.begin(), b.begin() + W, a.begin());
+			energy[0] = 0.0;
+			for (std::size_t j = 0; j < span; ++j)
+				energy[j + 1] = energy[j] + b[j] * b[j];
+
+			real const e0 = energy[W];
+			if (!(e0 > W * 1e-12))
+				continue;
+
+			// a correlated with b, then the cumulative mean normalised difference
+			forward.executeReal(A.data(), a.data());
+			forward.executeReal(B.data(), b.data());
+			for (std::size_t k = 0; k < nBins; ++k)
+				B[k] *= std::conj(A[k]);
+			inverse.executeReal(b.data(), B.data(), 1.0 / N);
+			real sum = 0.0;
+			d[0] = 1.0;
+			for (std::size_t tau = 1; tau < tauMax; ++tau)
+			{
+				real const difference = e0 + energy[tau + W] - energy[tau] -
+				                        2 * b[tau];
+				sum += difference;
+				d[tau] = sum > 0.0 ? difference * tau / sum : 1.0;
+			}
+
+			std::size_t tau = tauMin;
+			while (tau + 1 < tauMax && !(d[tau] < threshold))
+				++tau;
+			if (tau + 1 >= tauMax)
+				continue;
+			while (tau + 2 < tauMax && d[tau + 1] < d[tau])
+				++tau;
+			real period = tau;
+			real const curvature = d[tau - 1] - 2 * d[tau] + d[tau + 1];
+			if (curvature > 0.0)
+				period += 0.5 * (d[tau - 1] - d[tau + 1]) / curvature;
+			pitch.frequencies[f] = sampleRate / period;
+		}
+	});
+
+	// Frame f covers the samples within half a hop of its centre
+	for (std::size_t f = 0; f < nFrames; )
+	{
+		if (!pitch.frequencies[f])
+		{
+			++f;
+			continue;
+		}
+		std::size_t const first = f;
+		while (f < nFrames && pitch.frequencies[f])
+			++f;
+		pitch.voiced.emplace_back(first ? first * hop - hop / 2 : 0,
+		                          std::min(length, f * hop - hop / 2));
+	}
+	return pitch;
+}
+
+} // namespace pg
@@ -0,0 +1,86 @@
+#ifndef _POLYGAMMA_MATH_DETECTION_HPP__
+#define _POLYGAMMA_MATH_DETECTION_HPP__
+
+#include <vector>
+
+#include "../core/polygamma.hpp"
+#include "Interval.hpp"
+
+namespace pg
+{
+
+/*
+ * Detectors stream over the signal in blocks, which are processed in
+ * parallel on ThreadPool::get(), so their memory does not depend on the
+ * length of the signal beyond their results. Positions are in samples.
+ */
+
+/**
+ * Samples examined at once by detectSilence.
+ */
+constexpr std::size_t SILENCE_BLOCK = 1 << 16;
+/**
+ * Window of the spectral flux in seconds, rounded down to a power of 2
+ * samples, at a hop of half of it.
+ */
+constexpr real ONSET_WINDOW = 0.04;
+/**
+ * An onset is the largest flux within ONSET_RADIUS frames and exceeds the
+ * mean of the flux from ONSET_HISTORY frames before to ONSET_RADIUS frames
+ * after it by the threshold.
+ */
+constexpr std::size_t ONSET_RADIUS = 3;
+constexpr std::size_t ONSET_HISTORY = 16;
+/**
+ * Hop of the pitch track in seconds.
+ */
+constexpr real PITCH_HOP = 0.01;
+/**
+ * Frames of the spectral flux and of the pitch track computed by a task.
+ */
+constexpr std::size_t DETECTION_CHUNK = 256;
+
+/**
+ * @brief Fundamental frequency of every frame of a signal.
+ */
+struct Pitch
+{
+	std::size_t hop; // Samples between the centres of the frames
+	std::vector<real> frequencies; // Hz, 0 for unvoiced frames
+	std::vector<Interval<std::size_t>> voiced; // Runs of voiced frames
+};
+
+/**
+ * @brief Finds the runs of at least minLength samples where every channel
+ *  stays within threshold, in amplitude.
+ */
+std::vector<Interval<std::size_t>> detectSilence(
+  real const* const* const channels, std::size_t nChannels,
+  std::size_t length, real threshold, std::size_t minLength);
+/**
+ * The spectral flux sums the increases of the logarithmic magnitude of every
+ * bin of every channel from one frame to the next. It is normalised to zero
+ * mean and unit deviation over the signal, so threshold is in deviations.
+ * @brief Finds the onsets, at least minDistance samples apart, in increasing
+ *  order.
+ */
+std::vector<std::size_t> detectOnsets(real const* const* const channels,
+                                      std::size_t nChannels,
+                                      std::size_t length, real sampleRate,
+                                      real threshold, std::size_t minDistance);
+/**
+ * The YIN estimator on the sum of the channels: the first dip of the
+ * cumulative mean normalised difference function below threshold gives the
+ * period, refined by a parabola. The difference function of a frame is
+ * derived from a cross-correlation through the FFT. Frames without a dip,
+ * or silent, are unvoiced.
+ * @brief Tracks the fundamental frequency between minFrequency and
+ *  maxFrequency every PITCH_HOP seconds.
+ */
+Pitch detectPitch(real const* const* const channels, std::size_t nChannels,
+                  std::size_t length, real sampleRate, real minFrequency,
+                  real maxFrequency, real threshold);
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_DETECTION_HPP__
@@ -0,0 +1,65 @@
+#include "fftKernels.hpp"
+
+#include <atomic>
+
+namespace pg
+{
+
+namespace
+{
+
+template <typename T>
+struct VecScalar
+{
+	typedef T V;
+	static constexpr std::size_t N = 1;
+	static V load(T const* p) noexcept { return *p; }
+	static void store(T* p, V x) noexcept { *p = x; }
+	static V add(V a, V b) noexcept { return a + b; }
+	static V sub(V a, V b) noexcept { return a - b; }
+	static V mul(V a, V b) noexcept { return a * b; }
+};
+
+std::atomic<SIMD> limit(SIMDAVX512);
+
+} // namespace
+
+
+// Implementations
+
+SIMD simdSupported() noexcept
+{
+	static SIMD const detected = []
+	{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f") && fftCompiledAVX512())
+			return SIMDAVX512;
+		if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+		    fftCompiledAVX2())
+			return SIMDAVX2;
+		if (__builtin_cpu_supports("sse2") && fftCompiledSSE2())
+			return SIMDSSE2;
+#endif
+		return SIMDScalar;
+	}();
+	SIMD const l = limit.load(std::memory_order_relaxed);
+	return detected < l ? detected : l;
+}
+void simdLimit(SIMD simd) noexcept
+{
+	limit.store(simd, std::memory_order_relaxed);
+}
+
+void fftRadix4Scalar(double* const re, double* const im, std::size_t length,
+                     std::size_t m, double const* const w, bool inverse) noexcept
+{
+	fftRadix4<VecScalar<double>>(re, im, length, m, w, inverse);
+}
+void fftRadix4Scalar(float* const re, float* const im, std::size_t length,
+                     std::size_t m, float const* const w, bool inverse) noexcept
+{
+	fftRadix4<VecScalar<float>>(re, im, length, m, w, inverse);
+}
+
+} // namespace pg
@@ -0,0 +1,184 @@
+#ifndef _POLYGAMMA_MATH_FFTKERNELS_HPP__
+#define _POLYGAMMA_MATH_FFTKERNELS_HPP__
+
+#include <cstddef>
+
+namespace pg
+{
+
+/**
+ * @brief Instruction sets for which FFT kernels exist, in increasing order.
+ */
+enum SIMD
+{
+	SIMDScalar,
+	SIMDSSE2,
+	SIMDAVX2, // With FMA
+	SIMDAVX512 // AVX-512F
+};
+
+/**
+ * Queries CPUID once. The result is capped by simdLimit(), and by the
+ * instruction sets the kernels were compiled for.
+ * @brief The best instruction set supported by the processor.
+ */
+SIMD simdSupported() noexcept;
+/**
+ * Lowering the limit forces the transforms onto slower kernels, which allows
+ * the scalar reference to be compared with the vector kernels. Thread-safe.
+ * @brief Caps the instruction set used by the kernels.
+ */
+void simdLimit(SIMD) noexcept;
+
+/**
+ * The data is in split (SoA) layout: the real and imaginary parts are held
+ * in separate arrays, so each vector lane performs an independent butterfly.
+ * w holds the six arrays Re w^k, Im w^k, Re w^2k, Im w^2k, Re w^3k, Im w^3k,
+ * each of length m, where w is the principal 4m-th root of unity in the
+ * direction of the transform.
+ *
+ * The vector kernels require m to be a multiple of fftLanes().
+ *
+ * @brief One radix-4 decimation in time stage, combining sub-transforms of
+ *  length m in blocks of 4m.
+ */
+typedef void (*FFTRadix4Double)(double* const re, double* const im,
+                                std::size_t length, std::size_t m,
+                                double const* const w, bool inverse);
+typedef void (*FFTRadix4Float)(float* const re, float* const im,
+                               std::size_t length, std::size_t m,
+                               float const* const w, bool inverse);
+
+void fftRadix4Scalar(double* const re, double* const im, std::size_t length,
+                     std::size_t m, double const* const w, bool inverse) noexcept;
+void fftRadix4Scalar(float* const re, float* const im, std::size_t length,
+                     std::size_t m, float const* const w, bool inverse) noexcept;
+void fftRadix4SSE2(double* const re, double* const im, std::size_t length,
+                   std::size_t m, double const* const w, bool inverse) noexcept;
+void fftRadix4SSE2(float* const re, float* const im, std::size_t length,
+                   std::size_t m, float const* const w, bool inverse) noexcept;
+void fftRadix4AVX2(double* const re, double* const im, std::size_t length,
+                   std::size_t m, double const* const w, bool inverse) noexcept;
+void fftRadix4AVX2(float* const re, float* const im, std::size_t length,
+                   std::size_t m, float const* const w, bool inverse) noexcept;
+void fftRadix4AVX512(double* const re, double* const im, std::size_t length,
+                     std::size_t m, double const* const w, bool inverse) noexcept;
+void fftRadix4AVX512(float* const re, float* const im, std::size_t length,
+                     std::size_t m, float const* const w, bool inverse) noexcept;
+
+/**
+ * @brief Whether the kernels of an instruction set were compiled with it
+ *  enabled. Otherwise they are the scalar reference.
+ */
+bool fftCompiledSSE2() noexcept;
+bool fftCompiledAVX2() noexcept;
+bool fftCompiledAVX512() noexcept;
+
+/**
+ * @brief Number of elements of type T in one vector of the instruction set.
+ */
+template <typename T>
+constexpr std::size_t fftLanes(SIMD simd) noexcept;
+
+/**
+ * Vec must provide the type V of a vector of Vec::N elements of type T and the
+ * static functions load, store, add, sub and mul. Each instruction set
+ * instantiates it in its own translation unit, compiled for that set.
+ * @brief Generic body of the radix-4 kernels.
+ */
+template <typename Vec, typename T>
+void fftRadix4(T* const re, T* const im, std::size_t length,
+               std::size_t m, T const* const w, bool inverse) noexcept;
+template <typename Vec, bool inverse, typename T>
+void fftRadix4(T* const re, T* const im, std::size_t length,
+               std::size_t m, T const* const w) noexcept;
+
+
+// Implementations
+
+template <typename T>
+constexpr std::size_t fftLanes(SIMD simd) noexcept
+{
+	return simd == SIMDAVX512 ? 64 / sizeof(T) :
+	       simd == SIMDAVX2 ? 32 / sizeof(T) :
+	       simd == SIMDSSE2 ? 16 / sizeof(T) : 1;
+}
+
+template <typename Vec, typename T>
+inline void fftRadix4(T* const re, T* const im, std::size_t length,
+                      std::size_t m, T const* const w, bool inverse) noexcept
+{
+	if (inverse)
+		fftRadix4<Vec, true>(re, im, length, m, w);
+	else
+		fftRadix4<Vec, false>(re, im, length, m, w);
+}
+template <typename Vec, bool inverse, typename T>
+inline void fftRadix4(T* const re, T* const im, std::size_t length,
+                      std::size_t m, T const* const w) noexcept
+{
+	typedef typename Vec::V V;
+	T const* const w1r = w;
+	T const* const w1i = w + m;
+	T const* const w2r = w + 2 * m;
+	T const* const w2i = w + 3 * m;
+	T const* const w3r = w + 4 * m;
+	T const* const w3i = w + 5 * m;
+	/*
+	 * In bit reversed order, the four sub-transforms of a block of 4m hold the
+	 * samples whose indices are 0, 2, 1 and 3 modulo 4 respectively.
+	 */
+	for (std::size_t base = 0; base < length; base += 4 * m)
+	{
+		T* const r0 = re + base;
+		T* const i0 = im + base;
+		T* const r1 = r0 + m, * const i1 = i0 + m;
+		T* const r2 = r1 + m, * const i2 = i1 + m;
+		T* const r3 = r2 + m, * const i3 = i2 + m;
+		for (std::size_t k = 0; k < m; k += Vec::N)
+		{
+			V const ar = Vec::load(r0 + k), ai = Vec::load(i0 + k);
+			V xr = Vec::load(r1 + k), xi = Vec::load(i1 + k);
+			V wr = Vec::load(w2r + k), wi = Vec::load(w2i + k);
+			V const cr = Vec::sub(Vec::mul(xr, wr), Vec::mul(xi, wi));
+			V const ci = Vec::add(Vec::mul(xr, wi), Vec::mul(xi, wr));
+			xr = Vec::load(r2 + k); xi = Vec::load(i2 + k);
+			wr = Vec::load(w1r + k); wi = Vec::load(w1i + k);
+			V const br = Vec::sub(Vec::mul(xr, wr), Vec::mul(xi, wi));
+			V const bi = Vec::add(Vec::mul(xr, wi), Vec::mul(xi, wr));
+			xr = Vec::load(r3 + k); xi = Vec::load(i3 + k);
+			wr = Vec::load(w3r + k); wi = Vec::load(w3i + k);
+			V const dr = Vec::sub(Vec::mul(xr, wr), Vec::mul(xi, wi));
+			V const di = Vec::add(Vec::mul(xr, wi), Vec::mul(xi, wr));
+
+			V const s0r = Vec::add(ar, cr), s0i = Vec::add(ai, ci);
+			V const s1r = Vec::sub(ar, cr), s1i = Vec::sub(ai, ci);
+			V const s2r = Vec::add(br, dr), s2i = Vec::add(bi, di);
+			V const s3r = Vec::sub(br, dr), s3i = Vec::sub(bi, di);
+
+			Vec::store(r0 + k, Vec::add(s0r, s2r));
+			Vec::store(i0 + k, Vec::add(s0i, s2i));
+			Vec::store(r2 + k, Vec::sub(s0r, s2r));
+			Vec::store(i2 + k, Vec::sub(s0i, s2i));
+			// s1 +- s3 multiplied by -i, or by i if inverse
+			if (inverse)
+			{
+				Vec::store(r1 + k, Vec::sub(s1r, s3i));
+				Vec::store(i1 + k, Vec::add(s1i, s3r));
+				Vec::store(r3 + k, Vec::add(s1r, s3i));
+				Vec::store(i3 + k, Vec::sub(s1i, s3r));
+			}
+			else
+			{
+				Vec::store(r1 + k, Vec::add(s1r, s3i));
+				Vec::store(i1 + k, Vec::sub(s1i, s3r));
+				Vec::store(r3 + k, Vec::sub(s1r, s3i));
+				Vec::store(i3 + k, Vec::add(s1i, s3r));
+			}
+		}
+	}
+}
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_FFTKERNELS_HPP__
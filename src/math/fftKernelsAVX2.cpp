@@ -0,0 +1,73 @@
+#include "fftKernels.hpp"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace pg
+{
+
+#ifdef __AVX2__
+namespace
+{
+
+struct VecDouble
+{
+	typedef __m256d V;
+	static constexpr std::size_t N = 4;
+	static V load(double const* p) noexcept { return _mm256_loadu_pd(p); }
+	static void store(double* p, V x) noexcept { _mm256_storeu_pd(p, x); }
+	static V add(V a, V b) noexcept { return _mm256_add_pd(a, b); }
+	static V sub(V a, V b) noexcept { return _mm256_sub_pd(a, b); }
+	static V mul(V a, V b) noexcept { return _mm256_mul_pd(a, b); }
+};
+struct VecFloat
+{
+	typedef __m256 V;
+	static constexpr std::size_t N = 8;
+	static V load(float const* p) noexcept { return _mm256_loadu_ps(p); }
+	static void store(float* p, V x) noexcept { _mm256_storeu_ps(p, x); }
+	static V add(V a, V b) noexcept { return _mm256_add_ps(a, b); }
+	static V sub(V a, V b) noexcept { return _mm256_sub_ps(a, b); }
+	static V mul(V a, V b) noexcept { return _mm256_mul_ps(a, b); }
+};
+
+} // namespace
+#endif
+
+
+// Implementations
+
+bool fftCompiledAVX2() noexcept
+{
+#ifdef __AVX2__
+	return true;
+#else
+	return false;
+#endif
+}
+
+/*
+ * Without compiler support for AVX2 the kernels fall back to the scalar
+ * reference. simdSupported() never selects them in that case.
+ */
+void fftRadix4AVX2(double* const re, double* const im, std::size_t length,
+                   std::size_t m, double const* const w, bool inverse) noexcept
+{
+#ifdef __AVX2__
+	fftRadix4<VecDouble>(re, im, length, m, w, inverse);
+#else
+	fftRadix4Scalar(re, im, length, m, w, inverse);
+#endif
+}
+void fftRadix4AVX2(float* const re, float* const im, std::size_t length,
+                   std::size_t m, float const* const w, bool inverse) noexcept
+{
+#ifdef __AVX2__
+	fftRadix4<VecFloat>(re, im, length, m, w, inverse);
+#else
+	fftRadix4Scalar(re, im, length, m, w, inverse);
+#endif
+}
+
+} // namespace pg
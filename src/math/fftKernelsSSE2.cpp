@@ -0,0 +1,73 @@
+#include "fftKernels.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace pg
+{
+
+#ifdef __SSE2__
+namespace
+{
+
+struct VecDouble
+{
+	typedef __m128d V;
+	static constexpr std::size_t N = 2;
+	static V load(double const* p) noexcept { return _mm_loadu_pd(p); }
+	static void store(double* p, V x) noexcept { _mm_storeu_pd(p, x); }
+	static V add(V a, V b) noexcept { return _mm_add_pd(a, b); }
+	static V sub(V a, V b) noexcept { return _mm_sub_pd(a, b); }
+	static V mul(V a, V b) noexcept { return _mm_mul_pd(a, b); }
+};
+struct VecFloat
+{
+	typedef __m128 V;
+	static constexpr std::size_t N = 4;
+	static V load(float const* p) noexcept { return _mm_loadu_ps(p); }
+	static void store(float* p, V x) noexcept { _mm_storeu_ps(p, x); }
+	static V add(V a, V b) noexcept { return _mm_add_ps(a, b); }
+	static V sub(V a, V b) noexcept { return _mm_sub_ps(a, b); }
+	static V mul(V a, V b) noexcept { return _mm_mul_ps(a, b); }
+};
+
+} // namespace
+#endif
+
+
+// Implementations
+
+bool fftCompiledSSE2() noexcept
+{
+#ifdef __SSE2__
+	return true;
+#else
+	return false;
+#endif
+}
+
+/*
+ * Without compiler support for SSE2 the kernels fall back to the scalar
+ * reference. simdSupported() never selects them in that case.
+ */
+void fftRadix4SSE2(double* const re, double* const im, std::size_t length,
+                   std::size_t m, double const* const w, bool inverse) noexcept
+{
+#ifdef __SSE2__
+	fftRadix4<VecDouble>(re, im, length, m, w, inverse);
+#else
+	fftRadix4Scalar(re, im, length, m, w, inverse);
+#endif
+}
+void fftRadix4SSE2(float* const re, float* const im, std::size_t length,
+                   std::size_t m, float const* const w, bool inverse) noexcept
+{
+#ifdef __SSE2__
+	fftRadix4<VecFloat>(re, im, length, m, w, inverse);
+#else
+	fftRadix4Scalar(re, im, length, m, w, inverse);
+#endif
+}
+
+} // namespace pg
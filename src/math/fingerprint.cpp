@@ -0,0 +1,182 @@
+#include "fingerprint.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "fourier.hpp"
+#include "window.hpp"
+
+namespace pg
+{
+
+/**
+ * @brief A point of the constellation.
+ */
+struct fingerprintPeak
+{
+	std::uint32_t time; // Frame
+	std::uint32_t frequency; // Quanta
+	real level; // dB
+};
+
+/**
+ * @brief Finds the peaks of the channels, ordered by time.
+ */
+std::vector<fingerprintPeak> fingerprintPeaks(real const* const* const channels,
+                                              std::size_t nChannels,
+                                              std::size_t length,
+                                              real sampleRate);
+
+
+// Implementations
+
+std::size_t fingerprintHop(real sampleRate) noexcept
+{
+	return std::max<long>(1, std::lround(sampleRate * FINGERPRINT_HOP));
+}
+
+std::vector<fingerprintPeak> fingerprintPeaks(real const* const* const channels,
+                                              std::size_t nChannels,
+                                              std::size_t length,
+                                              real sampleRate)
+{
+	std::size_t const hop = fingerprintHop(sampleRate);
+	// Up to 4 frames, at a power of 2 for the FFT
+	std::size_t windowLength = 2;
+	while (2 * windowLength <= 4 * hop)
+		windowLength *= 2;
+	std::size_t const nBins = windowLength / 2 + 1;
+	real const* const analysis = window(WindowHann, windowLength);
+	real const binWidth = sampleRate / windowLength;
+	std::size_t const binLow = std::min<std::size_t>(
+	                             std::ceil(FINGERPRINT_LOW / binWidth), nBins - 1);
+	std::size_t const binHigh = std::min<std::size_t>(
+	                              FINGERPRINT_HIGH / binWidth, nBins - 1);
+	std::size_t const nBand = binHigh - binLow + 1;
+	// A full scale sinusoid peaks at windowLength / 4 under a Hann window
+	real const norm = 4.0 / windowLength;
+
+	std::size_t const nFrames = dstftFrames(length, hop);
+	std::size_t const R = FINGERPRINT_RADIUS;
+	std::size_t const capacity = FINGERPRINT_CHUNK + 2 * R;
+	std::size_t const pad = (windowLength / 2 + hop - 1) / hop;
+	std::vector<real> signal((capacity + 2 * pad) * hop);
+	std::vector<complex> spectrogram(capacity * nBins);
+	std::vector<real> levels(capacity * nBand);
+	std::vector<real> across(capacity * nBand); // Maxima along frequency
+
+	std::vector<fingerprintPeak> peaks;
+	std::vector<fingerprintPeak> frame;
+	for (std::size_t start = 0; start < nFrames; start += FINGERPRINT_CHUNK)
+	{
+		std::size_t const end = std::min(nFrames, start + FINGERPRINT_CHUNK);
+		// The neighbours of the peaks on either side of the chunk
+		std::size_t const first = start > R ? start - R : 0;
+		std::size_t const last = std::min(nFrames, end + R);
+		std::size_t const n = last - first;
+
+		// Frame first is centred on sample pad hop of the mix of the chunk
+		std::size_t const nSignal = (n + 2 * pad) * hop;
+		std::ptrdiff_t const offset = (std::ptrdiff_t) (first * hop) -
+		                              (std::ptrdiff_t) (pad * hop);
+		for (std::size_t i = 0; i < nSignal; ++i)
+		{
+			std::ptrdiff_t const s = offset + (std::ptrdiff_t) i;
+			real v = 0.0;
+			if (s >= 0 && s < (std::ptrdiff_t) length)
+				for (std::size_t c = 0; c < nChannels; ++c)
+					v += channels[c][s];
+			signal[i] = v;
+		}
+		dstft(spectrogram.data(), signal.data(), nSignal, analysis,
+		      windowLength, hop, pad, pad + n);
+
+		for (std::size_t f = 0; f < n; ++f)
+			for (std::size_t k = 0; k < nBand; ++k)
+				levels[f * nBand + k] = 20 * std::log10(
+				  std::abs(spectrogram[f * nBins + binLow + k]) * norm + 1e-12);
+		for (std::size_t f = 0; f < n; ++f)
+		{
+			real const* const row = &levels[f * nBand];
+			for (std::size_t k = 0; k < nBand; ++k)
+			{
+				std::size_t const from = k > R ? k - R : 0;
+				std::size_t const to = std::min(nBand, k + R + 1);
+				across[f * nBand + k] = *std::max_element(row + from, row + to);
+			}
+		}
+
+		for (std::size_t t = start; t < end; ++t)
+		{
+			std::size_t const f = t - first;
+			std::size_t const from = f > R ? f - R : 0;
+			std::size_t const to = std::min(n, f + R + 1);
+			frame.clear();
+			for (std::size_t k = 0; k < nBand; ++k)
+			{
+				real const level = levels[f * nBand + k];
+				// Only maxima along frequency need checking along time
+				if (level < FINGERPRINT_FLOOR || level < across[f * nBand + k])
+					continue;
+				bool maximum = true;
+				for (std::size_t g = from; g < to && maximum; ++g)
+					maximum = across[g * nBand + k] <= level;
+				if (!maximum)
+					continue;
+				// A parabola through the neighbours locates the peak between bins
+				real bin = binLow + k;
+				if (k > 0 && k + 1 < nBand)
+				{
+					real const l = levels[f * nBand + k - 1];
+					real const r = levels[f * nBand + k + 1];
+					real const curvature = l - 2 * level + r;
+					if (curvature < 0.0)
+						bin += 0.5 * (l - r) / curvature;
+				}
+				frame.push_back(fingerprintPeak{
+				  (std::uint32_t) t,
+				  (std::uint32_t) std::lround(bin * binWidth / FINGERPRINT_QUANTUM),
+				  level});
+			}
+			std::size_t const kept = std::min(frame.size(), FINGERPRINT_PEAKS);
+			std::partial_sort(frame.begin(), frame.begin() + kept, frame.end(),
+			                  [](fingerprintPeak const& a, fingerprintPeak const& b)
+			{
+				return a.level > b.level;
+			});
+			peaks.insert(peaks.end(), frame.begin(), frame.begin() + kept);
+		}
+	}
+	return peaks;
+}
+
+std::vector<landmark> fingerprint(real const* const* const channels,
+                                  std::size_t nChannels, std::size_t length,
+                                  real sampleRate)
+{
+	std::vector<fingerprintPeak> const peaks =
+	  fingerprintPeaks(channels, nChannels, length, sampleRate);
+	std::vector<landmark> landmarks;
+	for (std::size_t i = 0; i < peaks.size(); ++i)
+	{
+		fingerprintPeak const& anchor = peaks[i];
+		std::size_t count = 0;
+		for (std::size_t j = i + 1; j < peaks.size() &&
+		     count < FINGERPRINT_FAN_OUT; ++j)
+		{
+			std::uint32_t const dt = peaks[j].time - anchor.time;
+			if (dt > FINGERPRINT_SPAN)
+				break;
+			int const df = (int) peaks[j].frequency - (int) anchor.frequency;
+			if (dt == 0 || std::abs(df) > (int) FINGERPRINT_SPREAD)
+				continue;
+			landmarks.push_back(landmark{
+			  (anchor.frequency & 0x3ff) << 14 | (std::uint32_t) (df + 128) << 6 | dt,
+			  anchor.time});
+			++count;
+		}
+	}
+	return landmarks;
+}
+
+} // namespace pg
@@ -0,0 +1,74 @@
+#ifndef _POLYGAMMA_MATH_FINGERPRINT_HPP__
+#define _POLYGAMMA_MATH_FINGERPRINT_HPP__
+
+#include <cstdint>
+#include <vector>
+
+#include "../core/polygamma.hpp"
+
+namespace pg
+{
+
+/*
+ * Landmark fingerprints: the peaks of the spectrogram form a constellation,
+ * and every peak (the anchor) is paired with the next few peaks in a zone
+ * after it. A pair hashes the frequency of the anchor, the difference of
+ * frequencies and the difference of times, which survive gain changes,
+ * noise and lossy coding, while the time of the anchor locates the pair.
+ *
+ * Times are counted in frames of FINGERPRINT_HOP seconds and frequencies in
+ * quanta of FINGERPRINT_QUANTUM Hz, so fingerprints of signals at different
+ * sample rates are comparable.
+ */
+
+constexpr real FINGERPRINT_HOP = 0.016; // Seconds
+constexpr real FINGERPRINT_QUANTUM = 15.625; // Hz
+constexpr real FINGERPRINT_LOW = 250.0; // Hz, band searched for peaks
+constexpr real FINGERPRINT_HIGH = 5000.0;
+constexpr real FINGERPRINT_FLOOR = -70.0; // dBFS, quieter peaks are ignored
+/**
+ * A peak is the largest value within this many bins and frames on either
+ * side.
+ */
+constexpr std::size_t FINGERPRINT_RADIUS = 10;
+constexpr std::size_t FINGERPRINT_PEAKS = 4; // Per frame, the loudest ones
+constexpr std::size_t FINGERPRINT_FAN_OUT = 4; // Pairs per anchor
+/**
+ * The target zone of an anchor: up to FINGERPRINT_SPAN frames later, and
+ * FINGERPRINT_SPREAD quanta either way.
+ */
+constexpr std::size_t FINGERPRINT_SPAN = 63;
+constexpr std::size_t FINGERPRINT_SPREAD = 127;
+/**
+ * Hashes hold the anchor frequency in 10 bits, the difference of frequencies
+ * in 8 bits and the difference of times in 6 bits.
+ */
+constexpr std::size_t FINGERPRINT_HASH_BITS = 24;
+/**
+ * Frames of the spectrogram held in memory at once.
+ */
+constexpr std::size_t FINGERPRINT_CHUNK = 1024;
+
+struct landmark
+{
+	std::uint32_t hash;
+	std::uint32_t time; // Frame of the anchor
+};
+
+/**
+ * @brief Number of samples in a frame at sampleRate.
+ */
+std::size_t fingerprintHop(real sampleRate) noexcept;
+/**
+ * The channels are summed. The spectrogram is computed FINGERPRINT_CHUNK
+ * frames at a time with dstft, so the memory does not depend on the length
+ * of the signal, and only the peaks, a few per frame, are kept.
+ * @brief Computes the landmarks of planar channels, ordered by time.
+ */
+std::vector<landmark> fingerprint(real const* const* const channels,
+                                  std::size_t nChannels, std::size_t length,
+                                  real sampleRate);
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_FINGERPRINT_HPP__
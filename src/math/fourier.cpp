@@ -1,240 +1,240 @@
 #include "fourier.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <vector>
+
+#include "FFTPlan.hpp"
+#include "parallel.hpp"
+#include "window.hpp"
 
 namespace pg
 {
 
-/**
- * @brief dftCT Discrete Fourier transform using Cooley-Tukey algorithm. Not
- *     exposed to the outside.
- * @param[out] spectrum The spectrum of 0th, mth, 2mth, ... elements of signal.
- * @param signal
- * @param length The length of the signal. Must be a power of 2.
- * @param modulo
- */
-void dftCT(complex* const spectrum,
-           real const* const signal,
-           std::size_t length, std::size_t modulo);
-
-
 // Implementations
 
 void windowRect(real* const window, std::size_t length)
 {
-	for (std::size_t j = 0; j < length; ++j)
-		window[j] = 1.0;
+	windowGenerate(window, WindowRect, length);
 }
 void windowGaussian(real* const window, std::size_t length, real sigma)
 {
-	real fac = 2.0 / (sigma * length);
-	for (std::size_t j = 0; j < length; ++j)
-	{
-		real temp = (j - length * 0.5) * fac;
-		window[j] = std::exp(-0.5 * temp * temp);
-	}
+	windowGenerate(window, WindowGaussian, length, sigma);
 }
 
-void dftCT(complex* const spectrum,
-           real const* const signal,
-           std::size_t length, std::size_t modulo)
+void windowHann(real* const window, std::size_t length)
 {
-	// Cooley-Tukey algorithm. See Wikipedia for details
-	if (length == 1) // Terminal case
-	{
-		spectrum[0] = signal[0];
-	}
-	else
+	real const* const hann = pg::window(WindowHann, length);
+	std::copy(hann, hann + length, window);
+}
+void windowDual(real* const synthesis, real const* const analysis,
+                std::size_t length, std::size_t hop)
+{
+	assert(hop >= 1 && hop <= length);
+	for (std::size_t r = 0; r < hop; ++r)
 	{
-		// Base: exp(-2 pi i / n)
-		complex w(std::cos(2 * M_PI / length),
-		          -std::sin(2 * M_PI / length));
-		std::size_t mid = length / 2;
-		dftCT(spectrum, signal, mid, 2 * modulo);
-		dftCT(spectrum + mid, signal + modulo, mid, 2 * modulo);
-		// Combine the DFTs
-		for (std::size_t i = 0; i < mid; ++i)
-		{
-			complex temp = spectrum[i];
-			complex transformed = std::pow(w, i) * spectrum[i + mid];
-			spectrum[i] = temp + transformed;
-			spectrum[i + mid] = temp - transformed;
-		}
+		real energy = 0.0;
+		for (std::size_t j = r; j < length; j += hop)
+			energy += analysis[j] * analysis[j];
+		for (std::size_t j = r; j < length; j += hop)
+			synthesis[j] = energy > 0.0 ? analysis[j] / energy : 0.0;
 	}
 }
 
 void dft(complex* const spectrum,
          real const* const signal, std::size_t length)
 {
-	dftCT(spectrum, signal, length, 1);
+	FFTPlan<real> const& plan = FFTPlan<real>::get(length, FFTPlan<real>::Forward);
+	for (std::size_t i = 0; i < length; ++i)
+		spectrum[i] = signal[i];
+	plan.execute(spectrum);
+}
+void idft(complex* const signal, complex const* const spectrum,
+          std::size_t length)
+{
+	FFTPlan<real>::get(length, FFTPlan<real>::Inverse)
+	.execute(signal, spectrum, 1.0 / length);
+}
+void dftReal(complex* const spectrum,
+             real const* const signal, std::size_t length)
+{
+	assert(length >= 2);
+	FFTPlan<real>::get(length, FFTPlan<real>::Forward)
+	.executeReal(spectrum, signal);
+}
+void idftReal(real* const signal, complex const* const spectrum,
+              std::size_t length)
+{
+	assert(length >= 2);
+	FFTPlan<real>::get(length, FFTPlan<real>::Inverse)
+	.executeReal(signal, spectrum, 1.0 / length);
 }
 
-// The arguments here are renamed
-void dstft(complex* const* const spectrogram,
-           real const* const signal, std::size_t n,
-           real const* const window, std::size_t r,
-           std::size_t p, std::size_t q,
-           real* const integrand)
+std::size_t dftLength(std::size_t n) noexcept
 {
-	assert(p <= q);
-	/*
-	 * Let length be n, start be sp, end be sq, and windowRadius be r. Let the
-	 * signal be represented as A[0..n[, the spectrogram be S[0..n[[0..2r[,
-	 * and the window be W[0..2r[
-	 */
+	// A power of 2 always lies below
+	std::size_t best = 2 * std::max<std::size_t>(2, n);
+	for (std::size_t p5 = 2; p5 < best; p5 *= 5)
+		for (std::size_t p35 = p5; p35 < best; p35 *= 3)
+		{
+			std::size_t p = p35;
+			while (p < n)
+				p *= 2;
+			best = std::min(best, p);
+		}
+	return best;
+}
+
+std::size_t dstftFrames(std::size_t length, std::size_t hop)
+{
+	assert(hop >= 1);
+	return length ? (length + 2 * hop - 2) / hop : 0;
+}
+void dstft(complex* const spectrogram,
+           real const* const signal, std::size_t length,
+           real const* const window, std::size_t windowLength,
+           std::size_t hop, std::size_t start, std::size_t end,
+           std::size_t nThreads)
+{
+	assert(windowLength >= 2 && hop >= 1);
+	assert(start <= end && end <= dstftFrames(length, hop));
+	std::size_t const nBins = windowLength / 2 + 1;
+	// Obtained once here to keep the cache lock out of the workers
+	FFTPlan<real> const& plan =
+	  FFTPlan<real>::get(windowLength, FFTPlan<real>::Forward);
+
+	auto const worker = [&](std::size_t first, std::size_t last)
+	{
+		std::vector<real> frame(windowLength);
+		for (std::size_t f = first; f < last; ++f)
+		{
+			/*
+			 * Only the part of the frame which overlaps with the signal is
+			 * windowed, the rest is padding.
+			 */
+			std::ptrdiff_t const offset = (std::ptrdiff_t) (f * hop) -
+			                              (std::ptrdiff_t) (windowLength / 2);
+			std::size_t const kMin = offset < 0 ? -offset : 0;
+			// The last frames may lie past the end at large hops
+			std::size_t const kMax = (std::size_t) std::max<std::ptrdiff_t>(
+			                           std::min<std::ptrdiff_t>(
+			                             windowLength, (std::ptrdiff_t) length - offset),
+			                           kMin);
+			std::fill(frame.begin(), frame.begin() + kMin, 0.0);
+			for (std::size_t k = kMin; k < kMax; ++k)
+				frame[k] = window[k] * signal[offset + k];
+			std::fill(frame.begin() + kMax, frame.end(), 0.0);
+			plan.executeReal(spectrogram + (f - start) * nBins, frame.data());
+		}
+	};
 
 	/*
-	 * If we assume that A is padded with zeroes, the main loop can be expressed
-	 * as (in pseudocode)
-	 *
-	 * for j <- [p..q[
-	 *     S[j] = DFT CORRELATE(W[0..2r[, A[j - r, j + r[)
-	 * end for
-	 *
-	 * where the CORRELATE subroutine is a simple loop dot multiplying
-	 * corresponding elements of W and A.
-	 * In the real routine, it is much more efficient to emulate padding rather
-	 * than actually allocating memory before and after A.
-	 *
-	 * For any j <- [p..q[, the range [j - r, j + r[ touches at least one
-	 * negative index if j - r < 0 with at most r - j paddings. Hence in total
-	 * r - p paddings are needed. Since paddings are erased as A fill into
-	 * succeeding elements, the paddings can be initialised only once.
-	 *
-	 * The range [j - r, j + r[ touches at least one out of bound index (n) if
-	 * j + r > n. That is, j > n - r. In some cases a j exists so that
-	 * [j - r, j + r[ touches both ends. Solving the inequalities j - r < 0 and
-	 * j > n - r gives n < 2r.
-	 *
-	 * Critical points:
-	 * (n >= 2r) r, n - r (n < 2r) n - r, r
+	 * Every thread takes a contiguous range of frames, which keeps its reads of
+	 * the signal and writes of the spectrogram sequential. Short transforms are
+	 * not worth a thread.
 	 */
-	if (n < 2 * r)
+	parallelRanges(start, end, threadCount(nThreads, end - start, 16), worker);
+}
+void idstft(real* const signal, std::size_t length,
+            complex const* const spectrogram,
+            real const* const analysis, real const* const synthesis,
+            std::size_t windowLength, std::size_t hop,
+            std::size_t start, std::size_t end,
+            std::size_t nThreads)
+{
+	assert(windowLength >= 2 && hop >= 1 && hop <= windowLength);
+	assert(start <= end && end <= dstftFrames(length, hop));
+	if (start == end) return;
+	std::size_t const nBins = windowLength / 2 + 1;
+	std::ptrdiff_t const radius = windowLength / 2;
+	FFTPlan<real> const& plan =
+	  FFTPlan<real>::get(windowLength, FFTPlan<real>::Inverse);
+
+	// The samples touched by the frames
+	std::size_t const first = (std::size_t) std::max<std::ptrdiff_t>(
+	                            (std::ptrdiff_t) (start * hop) - radius, 0);
+	std::size_t const last = (std::size_t) std::min<std::ptrdiff_t>(
+	                           (std::ptrdiff_t) ((end - 1) * hop) - radius +
+	                           windowLength, length);
+	std::size_t const nThreadsSamples = threadCount(nThreads, last - first, 4096);
+	parallelRanges(first, last, nThreadsSamples,
+	               [signal](std::size_t i0, std::size_t i1)
 	{
-		// Fills in the padding zeroes
-		if (p < r)
-			for (std::size_t k = 0; k < r - p; ++k)
-				integrand[k] = 0.0;
+		std::fill(signal + i0, signal + i1, 0.0);
+	});
 
-		/*
-		 * This loop corresponds to underflow but not overflow.
-		 * Using p + r < n instead of p < n - r to avoid unsigned arithmetic
-		 * overflow.
-		 */
-		if (p + r < n)
+	auto const accumulate = [&](std::size_t f0, std::size_t f1)
+	{
+		std::vector<real> frame(windowLength);
+		for (std::size_t f = f0; f < f1; ++f)
 		{
-			// n - r cannot be less than 0
-			std::size_t loopMax = std::min(q, n - r);
-			for (std::size_t j = p; j < loopMax; ++j)
-			{
-				for (std::size_t k = r - j; k < 2 * r; ++k)
-				{
-					integrand[k] = window[k] * signal[k + j - r];
-				}
-				dft(spectrogram[j], integrand, 2 * r);
-			}
+			plan.executeReal(frame.data(), spectrogram + (f - start) * nBins,
+			                 1.0 / windowLength);
+			std::ptrdiff_t const offset = (std::ptrdiff_t) (f * hop) - radius;
+			std::size_t const kMin = offset < 0 ? -offset : 0;
+			std::size_t const kMax = (std::size_t) std::max<std::ptrdiff_t>(
+			                           std::min<std::ptrdiff_t>(
+			                             windowLength, (std::ptrdiff_t) length - offset),
+			                           kMin);
+			for (std::size_t k = kMin; k < kMax; ++k)
+				signal[offset + k] += synthesis[k] * frame[k];
 		}
-		/*
-		 * This loop corresponds to underflow and overflow
-		 * Using q + r > n instead of q > n - r to avoid unsigned arithmetic
-		 * overflow.
-		 */
-		if (p < r && q + r > n)
-		{
-			// This should be max(p, n - r) if we are using signed arithmetic.
-			std::size_t loopMin = n <= r ? p : std::max(p, n - r);
-			std::size_t loopMax = std::min(q, r);
-
-			// Zeroes written to the beginning/end
-			for (std::size_t k = 0; k < 2 * r; ++k)
-				integrand[k] = 0;
-			for (std::size_t j = loopMin; j < loopMax; ++j)
-			{
-				integrand[n + r - j] = 0;
-				/*
-				 * r - j is guarenteed to not underflow.
-				 * Overflow occurs when k + j - r >= n. Rearranging gives
-				 * k >= n + r - j, which establishes the upper limit
-				 */
-				for (std::size_t k = r - j; k < n + r - j; ++k)
-				{
-					integrand[k] = window[k] * signal[k + j - r];
-				}
-				dft(spectrogram[j], integrand, 2 * r);
-			}
-		}
-		/*
-		 * This loop corresponds to overflow but not underflow.
-		 * If n < r, this condition can never be true, so n - r is guarenteed to
-		 * not cause an arithmetic overflow
-		 */
-		if (q > r)
+	};
+	/*
+	 * Neighbouring frames overlap, so the frames are cut into chunks of at
+	 * least a window's worth. Chunks of the same parity are then disjoint in the
+	 * signal, and the even ones are added before the odd ones.
+	 */
+	std::size_t const span = (windowLength + hop - 1) / hop;
+	std::size_t const nChunks = std::max<std::size_t>(
+	                              std::min(2 * threadCount(nThreads, end - start, 16),
+	                                       (end - start) / span), 1);
+	std::size_t const chunk = (end - start + nChunks - 1) / nChunks;
+	for (std::size_t parity = 0; parity < 2; ++parity)
+	{
+		std::size_t const nParity = (nChunks + 1 - parity) / 2;
+		if (!nParity) continue;
+		parallelRanges(0, nParity, nParity, [&](std::size_t c0, std::size_t c1)
 		{
-			std::size_t loopMin = std::max(p, r);
-			for (std::size_t k = n + r - loopMin; k < 2 * r; ++k)
-				integrand[k] = 0.0;
-			for (std::size_t j = loopMin; j < q; ++j)
+			for (std::size_t c = c0; c < c1; ++c)
 			{
-				integrand[n + r - j] = 0.0;
-				for (std::size_t k = 0; k < n + r - j; ++k)
-				{
-					integrand[k] = window[k] * signal[k + j - r];
-				}
-				dft(spectrogram[j], integrand, 2 * r);
+				std::size_t const f0 = start + (2 * c + parity) * chunk;
+				accumulate(std::min(f0, end), std::min(f0 + chunk, end));
 			}
-		}
+		});
 	}
-	else
-	{
-		if (p < r)
-		{
-			// Fills in the padding zeroes
-			for (std::size_t k = 0; k < r - p; ++k)
-				integrand[k] = 0.0;
 
-			std::size_t loopMax = std::min(r, q);
-			for (std::size_t j = p; j < loopMax; ++j)
-			{
-				for (std::size_t k = r - j; k < 2 * r; ++k)
-				{
-					integrand[k] = window[k] * signal[k + j - r];
-				}
-				dft(spectrogram[j], integrand, 2 * r);
-			}
-		}
-		if (p < n - r && q > r)
-		{
-			std::size_t loopMin = std::max(p, r);
-			std::size_t loopMax = std::min(q, n - r);
-			for (std::size_t j = loopMin; j < loopMax; ++j)
-			{
-				for (std::size_t k = 0; k < 2 * r; ++k)
-				{
-					integrand[k] = window[k] * signal[k + j - r];
-				}
-				dft(spectrogram[j], integrand, 2 * r);
-			}
-		}
-		if (q > n - r)
+	/*
+	 * Divide by the sum of the products of the windows of the frames present,
+	 * which makes the reconstruction exact for any pair of windows, including at
+	 * the ends of the range. Samples which no window reaches are silenced.
+	 */
+	real weightMax = 0.0;
+	for (std::size_t k = 0; k < windowLength; ++k)
+		weightMax = std::max(weightMax, std::abs(analysis[k] * synthesis[k]));
+	real const epsilon = weightMax * 1e-9;
+	parallelRanges(first, last, nThreadsSamples,
+	               [&](std::size_t i0, std::size_t i1)
+	{
+		for (std::size_t i = i0; i < i1; ++i)
 		{
-			std::size_t loopMin = std::max(p, n - r);
-			for (std::size_t k = n + r - loopMin; k < 2 * r; ++k)
-				integrand[k] = 0.0;
-			for (std::size_t j = loopMin; j < q; ++j)
+			// Frames f with 0 <= i - f * hop + radius < windowLength
+			std::ptrdiff_t const centreMax = (std::ptrdiff_t) i + radius;
+			std::ptrdiff_t const centreMin = centreMax - windowLength + 1;
+			std::size_t const fMin = std::max<std::ptrdiff_t>(
+			                           centreMin <= 0 ? 0 : (centreMin + hop - 1) / hop,
+			                           start);
+			std::size_t const fMax = std::min<std::size_t>(centreMax / hop + 1, end);
+			real weight = 0.0;
+			for (std::size_t f = fMin; f < fMax; ++f)
 			{
-				integrand[n + r - j] = 0.0;
-				for (std::size_t k = 0; k < n + r - j; ++k)
-				{
-					integrand[k] = window[k] * signal[k + j - r];
-				}
-				dft(spectrogram[j], integrand, 2 * r);
+				std::size_t const k = centreMax - f * hop;
+				weight += analysis[k] * synthesis[k];
 			}
+			signal[i] = std::abs(weight) > epsilon ? signal[i] / weight : 0.0;
 		}
-
-	}
-
-
+	});
 }
 
 } // namespace pg
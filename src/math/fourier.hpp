@@ -6,7 +6,10 @@
 namespace pg
 {
 
-
+/*
+ * The window functions below fill caller-provided memory. See window.hpp for
+ * the cached window library.
+ */
 void windowRect(real* const window, std::size_t length);
 /**
  * This function is not responsible for any allocation.
@@ -18,6 +21,22 @@ void windowRect(real* const window, std::size_t length);
  */
 void windowGaussian(real* const window, std::size_t length,
                     real sigma);
+/**
+ * This function is not responsible for any allocation.
+ * @brief windowHann Generates a periodic Hann window of length. Overlapping
+ *  copies at a hop of length / 4 sum to a constant.
+ */
+void windowHann(real* const window, std::size_t length);
+/**
+ * This function is not responsible for any allocation.
+ * @brief windowDual Generates the synthesis window which gives perfect
+ *  reconstruction with the analysis window at hop in overlap-add, i.e.
+ *  analysis[k] divided by the sum of analysis[j]^2 over j = k modulo hop.
+ * @param[in] hop Must be in [1, length]. The analysis window must not vanish
+ *  on all samples of any residue modulo hop.
+ */
+void windowDual(real* const synthesis, real const* const analysis,
+                std::size_t length, std::size_t hop);
 /**
  * Implemented using fft algorithms. This function is not responsible for any
  * allocation and padding.
@@ -25,35 +44,123 @@ void windowGaussian(real* const window, std::size_t length,
  * @param[out] spectrum The spectrum of the signal. Should be allocated to have
  *     length of at least length.
  * @param[in] signal The signal.
- * @param[in] length The length of the signal. Must be >= 1 and a power of 2
+ * @param[in] length The length of the signal. Must be >= 1. Lengths with
+ *     prime factors other than 2, 3 and 5 are several times slower.
  */
 void dft(complex* const spectrum, real const* const signal, std::size_t length);
+/**
+ * Implemented using fft algorithms. This function is not responsible for any
+ * allocation and padding.
+ * @brief idft Inverse discrete Fourier transform, normalised so that
+ *  idft(dft(x)) = x.
+ * @param[out] signal The signal. Should be allocated to have length of at
+ *  least length. The imaginary parts vanish if spectrum is Hermitian.
+ * @param[in] spectrum The spectrum.
+ * @param[in] length The length of the spectrum. Must be >= 1
+ */
+void idft(complex* const signal, complex const* const spectrum,
+          std::size_t length);
+/**
+ * Computes the non-redundant half of the spectrum of a real signal with a
+ * complex transform of half the length if the length is even. This function
+ * is not responsible for any allocation and padding.
+ * @brief dftReal Discrete Fourier transform of a real signal
+ * @param[out] spectrum The bins 0 to length / 2 inclusive. Should be allocated
+ *     to have length of at least length / 2 + 1. The remaining bins are the
+ *     complex conjugates of these.
+ * @param[in] signal The signal.
+ * @param[in] length The length of the signal. Must be >= 2
+ */
+void dftReal(complex* const spectrum, real const* const signal,
+             std::size_t length);
+/**
+ * This function is not responsible for any allocation and padding.
+ * @brief idftReal Inverse of dftReal, normalised so that
+ *  idftReal(dftReal(x)) = x.
+ * @param[out] signal The signal. Should be allocated to have length of at
+ *  least length.
+ * @param[in] spectrum The bins 0 to length / 2 inclusive. The imaginary parts
+ *  of the bin 0, and of the bin length / 2 if length is even, are ignored.
+ * @param[in] length The length of the signal. Must be >= 2
+ */
+void idftReal(real* const signal, complex const* const spectrum,
+              std::size_t length);
 
 /**
- * This function is not responsible for any allocation.
+ * @brief dftLength Smallest even length >= n whose prime factors are 2, 3 and
+ *  5, the lengths which the transforms above handle fastest.
+ */
+std::size_t dftLength(std::size_t n) noexcept;
+
+/**
+ * Every sample of the signal then lies on the centre of a frame or between
+ * the centres of two frames, so the last frame may be centred past the end.
+ * @brief dstftFrames Number of frames of the short-time Fourier transform of a
+ *  signal of length samples at a hop of hop samples, i.e. the number of frame
+ *  centres in [0, length - 1 + hop[.
+ */
+std::size_t dstftFrames(std::size_t length, std::size_t hop);
+/**
+ * Frame f is centred on the sample f * hop, i.e. it transforms
+ * signal[f * hop - windowLength / 2 + k] * window[k] for k < windowLength,
+ * with the signal padded by zeroes on both ends. Frames are independent, so
+ * they are distributed over nThreads threads, each with its own scratch
+ * memory. This function is not responsible for any allocation.
  * @brief dstft Discrete short-time Fourier transform
- * @param[out] spectrogram A two dimensional row major matrix that will be
- *     filled with the spectrogram of the signal. The width of this matrix
- *     should be equal to length and the height should be windowRadius * 2.
+ * @param[out] spectrogram A two dimensional row major matrix of
+ *     end - start frames of windowLength / 2 + 1 bins each, since only the
+ *     non-redundant half of each spectrum is computed. Frame f is found at
+ *     spectrogram + (f - start) * (windowLength / 2 + 1).
  * @param[in] signal The signal. Will be correlated(not convolved!) against
  *     window to produce the spectrogram.
  * @param[in] length The length of the signal. Must be >= 1
- * @param[in] window The window function that will be used to calculate the
- *     transform. window[0] to window[2 * r - 1] should be allocated.
- * @param[in] windowRadius The radius of the window. Must be >= 1 and a power of
- *     2. The peak of the window should be window[r - 1] and window[r]. The
- *     latter is considered to be the zero.
- * @param[in] start The interval [start,end[ of the spectrogram will be
- *     computed, with everything else left untouched.
- *     start and end should satisfy 0 <= start < end < length
+ * @param[in] window The window function. window[0] to
+ *     window[windowLength - 1] should be allocated.
+ * @param[in] windowLength The length of the window. Must be >= 2. Lengths with
+ *     prime factors other than 2, 3 and 5 are several times slower.
+ * @param[in] hop The distance between the centres of consecutive frames.
+ *     Must be >= 1
+ * @param[in] start The frames [start,end[ will be computed.
+ *     start and end should satisfy start <= end <= dstftFrames(length, hop)
  * @param[in] end See \ref start.
- * @param integrand Temporary memory allocated with size 2 * windowRadius
+ * @param[in] nThreads Number of threads. 0 uses one per hardware thread.
  */
-void dstft(complex* const* const spectrogram,
+void dstft(complex* const spectrogram,
            real const* const signal, std::size_t length,
-           real const* const window, std::size_t windowRadius,
-           std::size_t start, std::size_t end,
-           real* const integrand);
+           real const* const window, std::size_t windowLength,
+           std::size_t hop, std::size_t start, std::size_t end,
+           std::size_t nThreads = 0);
+/**
+ * The frames are transformed back, multiplied by the synthesis window and
+ * overlap-added, i.e. weighted overlap-add. Every sample is then divided by
+ * the sum of analysis[k] * synthesis[k] over the frames which cover it, so
+ * idstft(dstft(x)) = x for any pair of windows whose product does not vanish,
+ * including near the ends of the signal. For pairs which sum to a constant at
+ * the given hop (e.g. a periodic Hann window at a hop of windowLength / 4 and
+ * its dual, see windowDual), this is the usual perfect reconstruction
+ * overlap-add. Near the ends, the frames of dstftFrames keep a centre within
+ * hop of every sample, so the sum stays away from 0 if hop <= windowLength / 2
+ * and the windows do not vanish within hop of their centres. Samples where
+ * it falls below 1e-9 of the largest product are set to 0 rather than
+ * amplified.
+ * @brief idstft Inverse of dstft
+ * @param[out] signal The signal. Only the samples covered by the frames
+ *     [start, end[ are written, which is the whole signal for all frames if
+ *     hop <= windowLength / 2.
+ * @param[in] length The length of the signal.
+ * @param[in] spectrogram The frames [start, end[ in the layout of dstft
+ * @param[in] analysis The window used by dstft.
+ * @param[in] synthesis The window applied to the frames before they are added.
+ * @param[in] windowLength The length of both windows. Must be >= 2
+ * @param[in] hop Must be in [1, windowLength]
+ * @param[in] nThreads Number of threads. 0 uses one per hardware thread.
+ */
+void idstft(real* const signal, std::size_t length,
+            complex const* const spectrogram,
+            real const* const analysis, real const* const synthesis,
+            std::size_t windowLength, std::size_t hop,
+            std::size_t start, std::size_t end,
+            std::size_t nThreads = 0);
 
 } // namespace pg
 
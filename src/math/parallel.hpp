@@ -0,0 +1,53 @@
+#ifndef _POLYGAMMA_MATH_PARALLEL_HPP__
+#define _POLYGAMMA_MATH_PARALLEL_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+
+#include "ThreadPool.hpp"
+
+namespace pg
+{
+
+/**
+ * @brief Number of threads to use for n items when every thread should get at
+ *  least itemsMin items. nThreads = 0 requests one per hardware thread.
+ */
+std::size_t threadCount(std::size_t nThreads, std::size_t n,
+                        std::size_t itemsMin) noexcept;
+/**
+ * The ranges are run as one job of ThreadPool::get(), so nThreads beyond its
+ * concurrency only makes the ranges smaller.
+ * @brief Splits [begin, end[ into nThreads contiguous ranges and calls
+ *  worker(first, last) on each in parallel.
+ */
+template <typename Worker>
+void parallelRanges(std::size_t begin, std::size_t end, std::size_t nThreads,
+                    Worker const& worker);
+
+
+// Implementations
+
+inline std::size_t threadCount(std::size_t nThreads, std::size_t n,
+                               std::size_t itemsMin) noexcept
+{
+	if (!nThreads)
+		nThreads = std::max(std::thread::hardware_concurrency(), 1U);
+	return std::max<std::size_t>(std::min(nThreads, n / itemsMin), 1);
+}
+template <typename Worker>
+void parallelRanges(std::size_t begin, std::size_t end, std::size_t nThreads,
+                    Worker const& worker)
+{
+	std::size_t const chunk = (end - begin + nThreads - 1) / nThreads;
+	ThreadPool::get().run(nThreads, [&](std::size_t i)
+	{
+		worker(std::min(begin + i * chunk, end),
+		       std::min(begin + (i + 1) * chunk, end));
+	});
+}
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_PARALLEL_HPP__
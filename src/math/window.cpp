@@ -0,0 +1,239 @@
+#include "window.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include "fourier.hpp"
+
+namespace pg
+{
+
+/**
+ * Evaluated by series so that it can run at compile time. k is reduced
+ * modulo n and the angle folded into [0, pi / 2] first, where 12 terms are
+ * accurate to the last bit.
+ * @brief cos(2 pi k / n)
+ */
+constexpr real cosTurn(std::size_t k, std::size_t n) noexcept;
+/**
+ * @brief The generalised cosine window
+ *  a0 - a1 cos(x) + a2 cos(2x) - a3 cos(3x) + a4 cos(4x) at x = 2 pi k / n.
+ */
+constexpr real cosineSum(std::size_t k, std::size_t n, real a0, real a1,
+                         real a2, real a3, real a4) noexcept;
+
+/**
+ * @brief Windows of the lengths 1, 2, 4, ..., WINDOW_STATIC_MAX concatenated,
+ *  so the window of length n starts at values[n - 1].
+ */
+struct WindowTable
+{
+	real values[2 * WINDOW_STATIC_MAX - 1];
+};
+constexpr WindowTable windowTable(real a0, real a1, real a2, real a3,
+                                  real a4) noexcept;
+
+/**
+ * @brief Coefficients of the cosine sum of type, or nullptr if type is not a
+ *  cosine sum.
+ */
+real const* cosineCoefficients(WindowType) noexcept;
+/**
+ * @brief The compile-time table of type, or nullptr if there is none.
+ */
+WindowTable const* windowStatic(WindowType) noexcept;
+/**
+ * @brief Modified Bessel function of the first kind of order 0.
+ */
+real besselI0(real x) noexcept;
+
+
+// Implementations
+
+constexpr real COSINE_RECT[] = {1.0, 0.0, 0.0, 0.0, 0.0};
+constexpr real COSINE_HANN[] = {0.5, 0.5, 0.0, 0.0, 0.0};
+constexpr real COSINE_HAMMING[] = {0.54, 0.46, 0.0, 0.0, 0.0};
+constexpr real COSINE_BLACKMAN_HARRIS[] =
+{0.35875, 0.48829, 0.14128, 0.01168, 0.0};
+constexpr real COSINE_FLAT_TOP[] =
+{0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368};
+
+constexpr real cosTurn(std::size_t k, std::size_t n) noexcept
+{
+	// Fold 2 pi k / n into [0, pi]
+	k %= n;
+	if (2 * k > n) k = n - k;
+	real x = 2 * M_PI * k / n;
+	real sign = 1.0;
+	if (x > M_PI / 2)
+	{
+		x = M_PI - x;
+		sign = -1.0;
+	}
+	real term = 1.0;
+	real sum = 1.0;
+	for (int i = 1; i <= 12; ++i)
+	{
+		term *= -x * x / ((2 * i - 1) * (2 * i));
+		sum += term;
+	}
+	return sign * sum;
+}
+constexpr real cosineSum(std::size_t k, std::size_t n, real a0, real a1,
+                         real a2, real a3, real a4) noexcept
+{
+	return a0 - a1 * cosTurn(k, n) + a2 * cosTurn(2 * k, n)
+	       - a3 * cosTurn(3 * k, n) + a4 * cosTurn(4 * k, n);
+}
+constexpr WindowTable windowTable(real a0, real a1, real a2, real a3,
+                                  real a4) noexcept
+{
+	WindowTable table{};
+	for (std::size_t n = 1; n <= WINDOW_STATIC_MAX; n *= 2)
+		for (std::size_t k = 0; k < n; ++k)
+			table.values[n - 1 + k] = cosineSum(k, n, a0, a1, a2, a3, a4);
+	return table;
+}
+
+#define WINDOW_TABLE(c) windowTable(c[0], c[1], c[2], c[3], c[4])
+constexpr WindowTable TABLE_RECT = WINDOW_TABLE(COSINE_RECT);
+constexpr WindowTable TABLE_HANN = WINDOW_TABLE(COSINE_HANN);
+constexpr WindowTable TABLE_HAMMING = WINDOW_TABLE(COSINE_HAMMING);
+constexpr WindowTable TABLE_BLACKMAN_HARRIS =
+  WINDOW_TABLE(COSINE_BLACKMAN_HARRIS);
+constexpr WindowTable TABLE_FLAT_TOP = WINDOW_TABLE(COSINE_FLAT_TOP);
+#undef WINDOW_TABLE
+
+real const* cosineCoefficients(WindowType type) noexcept
+{
+	switch (type)
+	{
+	case WindowRect: return COSINE_RECT;
+	case WindowHann: return COSINE_HANN;
+	case WindowHamming: return COSINE_HAMMING;
+	case WindowBlackmanHarris: return COSINE_BLACKMAN_HARRIS;
+	case WindowFlatTop: return COSINE_FLAT_TOP;
+	default: return nullptr;
+	}
+}
+WindowTable const* windowStatic(WindowType type) noexcept
+{
+	switch (type)
+	{
+	case WindowRect: return &TABLE_RECT;
+	case WindowHann: return &TABLE_HANN;
+	case WindowHamming: return &TABLE_HAMMING;
+	case WindowBlackmanHarris: return &TABLE_BLACKMAN_HARRIS;
+	case WindowFlatTop: return &TABLE_FLAT_TOP;
+	default: return nullptr;
+	}
+}
+real besselI0(real x) noexcept
+{
+	// Power series, which converges for all x
+	real const y = x * x / 4;
+	real term = 1.0;
+	real sum = 1.0;
+	for (int m = 1; term > sum * 1e-17; ++m)
+	{
+		term *= y / (m * m);
+		sum += term;
+	}
+	return sum;
+}
+
+void windowGenerate(real* const out, WindowType type, std::size_t length,
+                    real parameter)
+{
+	assert(length >= 1);
+	if (real const* const c = cosineCoefficients(type))
+	{
+		for (std::size_t k = 0; k < length; ++k)
+			out[k] = cosineSum(k, length, c[0], c[1], c[2], c[3], c[4]);
+		return;
+	}
+	switch (type)
+	{
+	case WindowKaiser:
+	{
+		real const norm = 1.0 / besselI0(parameter);
+		for (std::size_t k = 0; k < length; ++k)
+		{
+			real const r = (2.0 * k - length) / length;
+			out[k] = besselI0(parameter * std::sqrt(1.0 - r * r)) * norm;
+		}
+		break;
+	}
+	case WindowGaussian:
+	{
+		real const fac = 2.0 / (parameter * length);
+		for (std::size_t k = 0; k < length; ++k)
+		{
+			real const t = (k - length * 0.5) * fac;
+			out[k] = std::exp(-0.5 * t * t);
+		}
+		break;
+	}
+	default:
+		assert(false && "Unknown window");
+	}
+}
+
+/**
+ * @brief Looks up the window with the given key, generating it with
+ *  generate(std::vector<real>&) if absent.
+ */
+template <typename Generator>
+real const* windowCached(WindowType type, std::size_t length, std::size_t hop,
+                         real parameter, Generator const& generate)
+{
+	static std::mutex mutex;
+	static std::map<std::tuple<WindowType, std::size_t, std::size_t, real>,
+	                std::unique_ptr<std::vector<real>>> cache;
+
+	// Parameterless windows must not be told apart by the parameter
+	if (cosineCoefficients(type)) parameter = 0.0;
+	std::unique_ptr<std::vector<real>>* entry;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		entry = &cache[std::make_tuple(type, length, hop, parameter)];
+		if (*entry) return (*entry)->data();
+	}
+	// Generated outside of the lock, as the dual requests its window
+	std::unique_ptr<std::vector<real>> created(new std::vector<real>(length));
+	generate(*created);
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!*entry) *entry = std::move(created);
+	return (*entry)->data();
+}
+
+real const* window(WindowType type, std::size_t length, real parameter)
+{
+	assert(length >= 1);
+	WindowTable const* const table = windowStatic(type);
+	if (table && length <= WINDOW_STATIC_MAX && !(length & (length - 1)))
+		return table->values + length - 1;
+
+	return windowCached(type, length, 0, parameter,
+	                    [=](std::vector<real>& out)
+	{
+		windowGenerate(out.data(), type, length, parameter);
+	});
+}
+real const* windowSynthesis(WindowType type, std::size_t length,
+                            std::size_t hop, real parameter)
+{
+	assert(hop >= 1 && hop <= length);
+	return windowCached(type, length, hop, parameter,
+	                    [=](std::vector<real>& out)
+	{
+		windowDual(out.data(), window(type, length, parameter), length, hop);
+	});
+}
+
+} // namespace pg
@@ -0,0 +1,57 @@
+#ifndef _POLYGAMMA_MATH_WINDOW_HPP__
+#define _POLYGAMMA_MATH_WINDOW_HPP__
+
+#include "../core/polygamma.hpp"
+
+namespace pg
+{
+
+/**
+ * All windows are periodic, i.e. sampled from a window of length + 1 samples
+ * with the last one dropped, which is the form the short-time Fourier
+ * transform needs. The peak lies at window[length / 2].
+ */
+enum WindowType
+{
+	WindowRect,
+	WindowHann,
+	WindowHamming,
+	WindowBlackmanHarris, // 4 term, -92 dB side lobes
+	WindowFlatTop, // 5 term, for amplitude measurements
+	WindowKaiser, // parameter: beta
+	WindowGaussian // parameter: sigma, see windowGaussian
+};
+
+/**
+ * Windows of parameterless types whose length is a power of 2 up to this are
+ * generated at compile time.
+ */
+constexpr std::size_t WINDOW_STATIC_MAX = 512;
+
+/**
+ * Thread-safe. Windows are memoised by (type, length, parameter) in a process
+ * wide cache and live until the end of the program, so the pointer may be
+ * kept. Windows with compile-time tables bypass the cache entirely.
+ * @brief Obtains a window of length >= 1 samples.
+ * @param[in] parameter Ignored by the types which have none.
+ */
+real const* window(WindowType, std::size_t length, real parameter = 0.0);
+/**
+ * Thread-safe and memoised like window().
+ * @brief Obtains the synthesis dual of window(type, length, parameter) at
+ *  hop, see windowDual.
+ * @param[in] hop Must be in [1, length]
+ */
+real const* windowSynthesis(WindowType, std::size_t length, std::size_t hop,
+                            real parameter = 0.0);
+/**
+ * This function is not responsible for any allocation and bypasses the
+ * cache.
+ * @brief Generates a window of length samples into out.
+ */
+void windowGenerate(real* const out, WindowType, std::size_t length,
+                    real parameter = 0.0);
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_MATH_WINDOW_HPP__
@@ -9,21 +9,63 @@ void Media_init(struct Media* const media)
 }
 void Media_set_cursor(struct Media* const m, size_t cursor)
 {
-	size_t bytes = av_get_bytes_per_sample(m->sampleFormat) * cursor;
-	if (bytes < m->cursor)
-	{
-		size_t shift = m->cursor - bytes;
-		for (size_t i = 0; i < m->nChannels; ++i)
-			m->samples[i] -= shift;
-	}
-	else
+	assert(m);
+	m->cursor = cursor < m->nSamples ? cursor : m->nSamples;
+}
+size_t Media_get_cursor(struct Media* const m)
+{
+	assert(m);
+	return m->cursor;
+}
+size_t Media_get_playhead(struct Media const* const m)
+{
+	assert(m);
+	if (!__atomic_load_n(&m->playing, __ATOMIC_ACQUIRE))
+		return __atomic_load_n(&m->cursor, __ATOMIC_RELAXED);
+
+	unsigned sequence;
+	size_t cursor, consumed, produced, latency;
+	uint64_t time;
+	// Retry until the audio thread is not publishing
+	while (true)
 	{
-		size_t shift = bytes - m->cursor;
-		for (size_t i = 0; i < m->nChannels; ++i)
-			m->samples[i] += shift;
+		sequence = __atomic_load_n(&m->clockSequence, __ATOMIC_ACQUIRE);
+		cursor = __atomic_load_n(&m->clockCursor, __ATOMIC_RELAXED);
+		consumed = __atomic_load_n(&m->clockConsumed, __ATOMIC_RELAXED);
+		produced = __atomic_load_n(&m->clockProduced, __ATOMIC_RELAXED);
+		time = __atomic_load_n(&m->clockTime, __ATOMIC_RELAXED);
+		latency = __atomic_load_n(&m->clockLatency, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (!(sequence & 1) &&
+		    sequence == __atomic_load_n(&m->clockSequence, __ATOMIC_RELAXED))
+			break;
 	}
+
+	if (!produced) return cursor;
+
+	/*
+	 * Output samples played since the beginning of the block. Interpolate
+	 * within the block, but never past its end.
+	 */
+	uint64_t const now = SDL_GetPerformanceCounter();
+	double const elapsed = (double) (now - time) / SDL_GetPerformanceFrequency();
+	double played = elapsed * m->deviceRate - (double) latency;
+	if (played > produced) played = produced;
+
+	// Convert to source samples
+	double const position = cursor + played * consumed / produced;
+	return position > 0.0 ? (size_t) position : 0;
 }
-size_t Media_get_cursor(struct Media* const m)
+void Media_clock_publish(struct Media* const m, size_t cursor,
+                         size_t consumed, size_t produced, uint64_t time)
 {
-	return m->cursor / av_get_bytes_per_sample(m->sampleFormat);
+	assert(m);
+	unsigned const sequence = m->clockSequence;
+	__atomic_store_n(&m->clockSequence, sequence + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	__atomic_store_n(&m->clockCursor, cursor, __ATOMIC_RELAXED);
+	__atomic_store_n(&m->clockConsumed, consumed, __ATOMIC_RELAXED);
+	__atomic_store_n(&m->clockProduced, produced, __ATOMIC_RELAXED);
+	__atomic_store_n(&m->clockTime, time, __ATOMIC_RELAXED);
+	__atomic_store_n(&m->clockSequence, sequence + 2, __ATOMIC_RELEASE);
 }
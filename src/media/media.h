@@ -15,17 +15,78 @@ struct Media
 	size_t nChannels;
 	unsigned int sampleRate;
 	size_t nSamples;
+	/*
+	 * Index of the next sample to be rendered. samples always points to the
+	 * beginning of the data.
+	 */
 	size_t cursor;
 
 	// Initialised by play routine
 	struct SwrContext* swrContext;
-	SDL_AudioDeviceID audioDevice;
+	SDL_AudioDeviceID audioDevice; // 0 when rendering offline
+	unsigned int deviceRate; // Sample rate of the rendered stream
 	bool playing;
+
+	/*
+	 * Optional source. If set, the playback callback calls it on the audio
+	 * thread instead of copying the samples at the cursor. It fills up to
+	 * nSamples of every plane of block, stores the number of source samples
+	 * by which the cursor advances in consumed, and returns the number of
+	 * samples filled, fewer only once the source has ended. Must not block.
+	 */
+	size_t (*source)(void* sourceData, struct Media const* media,
+	                 double* const* block, size_t nSamples, size_t* consumed);
+	void* sourceData;
+	/*
+	 * Optional insert processing applied in place to block on the audio
+	 * thread before converting it for the device. Must not block.
+	 * media->audioDevice is 0 when rendering offline. The block was rendered
+	 * from consumed source samples from media->cursor onwards.
+	 */
+	void (*insert)(void* insertData, struct Media const* media,
+	               double* const* block, size_t nSamples, size_t consumed);
+	void* insertData;
+	// Allocated by play routine. nChannels planes of blockSize samples
+	double** block;
+	size_t blockSize;
+
+	/*
+	 * Playhead clock. Published by the audio thread after every callback
+	 * under the sequence lock clockSequence (odd while writing). Read through
+	 * Media_get_playhead.
+	 */
+	unsigned clockSequence;
+	size_t clockCursor; // cursor at the beginning of the callback
+	size_t clockConsumed; // Source samples consumed by the callback
+	size_t clockProduced; // Samples at deviceRate played by the callback
+	uint64_t clockTime; // SDL_GetPerformanceCounter() at the callback
+	// Samples at deviceRate queued in the device ahead of the callback
+	size_t clockLatency;
 };
 
 void Media_init(struct Media* const);
 
+/**
+ * @brief Sets the index of the next sample to be rendered.
+ */
 void Media_set_cursor(struct Media* const, size_t cursor);
 size_t Media_get_cursor(struct Media* const);
+/**
+ * Lock-free, may be called from any thread while the audio thread renders.
+ * While playing, the position is interpolated between callbacks from the
+ * device clock and compensated for the device latency. Speed changes by the
+ * source are accounted for.
+ * @brief Obtains the sample that is currently audible.
+ */
+size_t Media_get_playhead(struct Media const* const);
+
+/**
+ * @warning Only called by the audio thread, or while it is paused.
+ * @brief Publishes the playhead clock for a callback which began at time
+ *  with the cursor at cursor, consumed source samples and produced output
+ *  samples.
+ */
+void Media_clock_publish(struct Media* const, size_t cursor,
+                         size_t consumed, size_t produced, uint64_t time);
 
 #endif // !_POLYGAMMA_MEDIA_MEDIA_H__
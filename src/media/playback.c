@@ -1,43 +1,111 @@
 #include "playback.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #include <libavutil/channel_layout.h>
 
-void audio_callback(struct Media* m, uint8_t* stream, int len)
+size_t media_render(struct Media* const m, uint8_t* stream, size_t nSamples)
 {
 	assert(m);
-	size_t spc = len / (m->nChannels * sizeof(short)); // Samples/Channel
-	// Available sample/channel
-	size_t spcA = spc > m->nSamples - m->cursor ?
-		m->nSamples - m->cursor : spc;
-	assert(spcA <= spc);
+	size_t const bps = av_get_bytes_per_sample(m->sampleFormat);
+	uint64_t const time = SDL_GetPerformanceCounter();
+	size_t const cursor = m->cursor;
 
-	swr_convert(m->swrContext,
-	            (uint8_t**) &stream, spcA,
-	            (uint8_t const**) m->samples, spcA);
+	// Render one block at a time until the stream is full or the source ends
+	uint8_t* out = stream;
+	size_t produced = 0;
+	while (produced < nSamples)
+	{
+		size_t n = 0;
+		if (m->cursor < m->nSamples)
+		{
+			// Source samples needed to fill the rest of the stream
+			n = (nSamples - produced) * m->sampleRate / m->deviceRate + 1;
+			if (n > m->blockSize) n = m->blockSize;
+			size_t consumed;
+			if (m->source)
+			{
+				n = m->source(m->sourceData, m, m->block, n, &consumed);
+			}
+			else
+			{
+				if (n > m->nSamples - m->cursor)
+					n = m->nSamples - m->cursor;
+				for (size_t j = 0; j < m->nChannels; ++j)
+					memcpy(m->block[j], m->samples[j] + m->cursor * bps, n * bps);
+				consumed = n;
+			}
+			if (m->insert)
+				m->insert(m->insertData, m, m->block, n, consumed);
+
+			m->cursor += consumed;
+			if (m->cursor > m->nSamples)
+				m->cursor = m->nSamples;
+		}
+		// Once the source has ended, drain the resampler
+		int const written = swr_convert(m->swrContext,
+		                                &out, nSamples - produced,
+		                                n ? (uint8_t const**) m->block : NULL, n);
+		if (written < 0 || (!written && !n))
+			break;
+		out += written * m->nChannels * sizeof(short);
+		produced += written;
+	}
+	Media_clock_publish(m, cursor, m->cursor - cursor, produced, time);
+	return produced;
+}
+void audio_callback(struct Media* m, uint8_t* stream, int len)
+{
+	assert(m);
+	size_t const spc = len / (m->nChannels * sizeof(short)); // Samples/Channel
+	size_t const produced = media_render(m, stream, spc);
 
 	// Fill trailing space with zeroes
-	if (spcA < spc)
+	if (produced < spc)
 	{
-		size_t trailing = spcA * m->nChannels * sizeof(short);
+		size_t trailing = produced * m->nChannels * sizeof(short);
 		assert(trailing <= len);
 		memset(stream + trailing, 0, len - trailing);
-		m->playing = false;
+		__atomic_store_n(&m->playing, false, __ATOMIC_RELEASE);
 		SDL_PauseAudioDevice(m->audioDevice, true);
 		Media_set_cursor(m, 0);
 	}
-
-	// Advance the cursor
-	size_t batchSize = av_get_bytes_per_sample(m->sampleFormat) * spcA;
-	for (size_t j = 0; j < m->nChannels; ++j)
+}
+/**
+ * @brief Allocates the conversion to interleaved S16 at deviceRate and the
+ *  render block.
+ */
+static bool media_open_render(struct Media* const m, size_t blockSize)
+{
+	m->swrContext =
+	  swr_alloc_set_opts(NULL,
+	                     m->channelLayout, AV_SAMPLE_FMT_S16, m->deviceRate,
+	                     m->channelLayout, m->sampleFormat, m->sampleRate,
+	                     0, NULL);
+	if (!m->swrContext)
+	{
+		fprintf(stderr, "Unable to allocate SwrContext\n");
+		return false;
+	}
+	if (swr_init(m->swrContext) < 0)
 	{
-		m->samples[j] += batchSize;
+		fprintf(stderr, "Unable to initialise SwrContext\n");
+		swr_free(&m->swrContext);
+		return false;
 	}
-	m->cursor += batchSize;
+	if (!m->block)
+	{
+		m->blockSize = blockSize;
+		m->block = (double**) calloc(m->nChannels, sizeof(double*));
+		for (size_t i = 0; i < m->nChannels; ++i)
+			m->block[i] = (double*) malloc(m->blockSize * sizeof(double));
+	}
+	return true;
 }
-bool media_open(struct Media* const m)
+bool media_open(struct Media* const m, unsigned int deviceSamples)
 {
 	assert(m);
 	struct SDL_AudioSpec specTarget;
@@ -45,7 +113,7 @@ bool media_open(struct Media* const m)
 	specTarget.format = AUDIO_S16SYS;
 	specTarget.channels = m->nChannels;
 	specTarget.silence = false;
-	specTarget.samples = 1024 * m->nChannels;
+	specTarget.samples = deviceSamples;
 	specTarget.callback = (SDL_AudioCallback) audio_callback;
 	specTarget.userdata = m;
 
@@ -58,39 +126,50 @@ bool media_open(struct Media* const m)
 		fprintf(stderr, "[SDL] %s\n", SDL_GetError());
 		return false;
 	}
-	m->swrContext =
-	  swr_alloc_set_opts(NULL,
-	                     m->channelLayout, AV_SAMPLE_FMT_S16, spec.freq,
-	                     m->channelLayout, m->sampleFormat, m->sampleRate,
-	                     0, NULL);
-	if (!m->swrContext)
-	{
-		SDL_CloseAudioDevice(m->audioDevice);
-		fprintf(stderr, "Unable to allocate SwrContext\n");
-		return false;
-	}
-	if (swr_init(m->swrContext) < 0)
+	m->deviceRate = spec.freq;
+	// Samples which the device holds ahead of a callback
+	m->clockLatency = spec.samples;
+	if (!media_open_render(m, spec.samples))
 	{
-		fprintf(stderr, "Unable to initialise SwrContext\n");
-		swr_free(&m->swrContext);
 		SDL_CloseAudioDevice(m->audioDevice);
+		m->audioDevice = 0;
 		return false;
 	}
 	return true;
 }
+bool media_open_offline(struct Media* const m, unsigned int sampleRate)
+{
+	assert(m);
+	m->audioDevice = 0;
+	m->deviceRate = sampleRate;
+	m->clockLatency = 0;
+	return media_open_render(m, MEDIA_OFFLINE_BLOCK);
+}
 void media_close(struct Media* const m)
 {
 	if (!m) return;
 	swr_free(&m->swrContext);
-	SDL_CloseAudioDevice(m->audioDevice);
+	if (m->audioDevice)
+	{
+		SDL_CloseAudioDevice(m->audioDevice);
+		m->audioDevice = 0;
+	}
 	m->playing = false;
+	if (m->block)
+	{
+		for (size_t i = 0; i < m->nChannels; ++i)
+			free(m->block[i]);
+		free(m->block);
+		m->block = NULL;
+	}
 }
 
 bool media_play(struct Media* const m)
 {
 	assert(m);
+	Media_clock_publish(m, m->cursor, 0, 0, SDL_GetPerformanceCounter());
+	__atomic_store_n(&m->playing, true, __ATOMIC_RELEASE);
 	SDL_PauseAudioDevice(m->audioDevice, false);
-	m->playing = true;
 
 	return true;
 }
@@ -98,5 +177,5 @@ void media_stop(struct Media* const m)
 {
 	if (!m) return;
 	SDL_PauseAudioDevice(m->audioDevice, true);
-	m->playing = false;
+	__atomic_store_n(&m->playing, false, __ATOMIC_RELEASE);
 }
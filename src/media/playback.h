@@ -6,9 +6,35 @@
 
 #include "media.h"
 
-bool media_open(struct Media* const);
+/**
+ * Length of the blocks passed to the source and insert hooks when rendering
+ * offline.
+ */
+#define MEDIA_OFFLINE_BLOCK 4096
+
+/**
+ * @brief Opens an audio device for the media.
+ * @param deviceSamples Samples per channel in the device buffer. Smaller
+ *  buffers lower the latency at the cost of more frequent callbacks.
+ */
+bool media_open(struct Media* const, unsigned int deviceSamples);
+/**
+ * The rendering is identical to playback, including the conversion to
+ * interleaved S16, but no audio device is opened. Close with media_close.
+ * @brief Prepares the media for media_render at the given sample rate.
+ */
+bool media_open_offline(struct Media* const, unsigned int sampleRate);
 void media_close(struct Media* const);
 
+/**
+ * Called by the audio callback, or repeatedly by the offline renderer.
+ * @brief Renders up to nSamples interleaved S16 samples per channel from the
+ *  cursor into stream and advances the cursor.
+ * @return The number of samples per channel written. Less than nSamples only
+ *  once the source has ended.
+ */
+size_t media_render(struct Media* const, uint8_t* stream, size_t nSamples);
+
 bool media_play(struct Media* const);
 void media_stop(struct Media* const);
 
@@ -0,0 +1,88 @@
+#include "Automation.hpp"
+
+#include <algorithm>
+
+#include "../math/arithmetic.hpp"
+
+namespace pg
+{
+
+constexpr std::size_t Automation::BLOCK_SIZE;
+
+Automation::Automation(std::size_t nChannels):
+	nChannels(nChannels), back(0), middle(1), front(2)
+{
+	staged.volumeActive = staged.panActive = false;
+	staged.pan = Envelope(0.0);
+	for (auto& s: settings)
+		s = staged;
+}
+
+void Automation::setVolume(Envelope const& envelope)
+{
+	staged.volume = envelope;
+	staged.volumeActive = true;
+	publish();
+}
+void Automation::setPan(Envelope const& envelope) throw(PythonException)
+{
+	if (nChannels != 2)
+		throw PythonException{"Pan requires a stereo buffer",
+		                      PythonException::ValueError};
+	for (auto const& point: envelope.getPoints())
+		if (!(point.value >= -1.0 && point.value <= 1.0))
+			throw PythonException{"Pan must lie in [-1, 1]",
+			                      PythonException::ValueError};
+	staged.pan = envelope;
+	staged.panActive = true;
+	publish();
+}
+void Automation::clear()
+{
+	staged.volumeActive = staged.panActive = false;
+	staged.volume.clear();
+	staged.pan.clear();
+	publish();
+}
+
+void Automation::process(real* const* const block, std::size_t length,
+                         std::size_t position, real step) noexcept
+{
+	// Acquire the latest settings, if any
+	if (middle.load(std::memory_order_relaxed) & FRESH)
+		front = middle.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+	Settings const& s = settings[front];
+	if (!s.volumeActive && !s.panActive)
+		return;
+
+	real gains[BLOCK_SIZE];
+	for (std::size_t offset = 0; offset < length; offset += BLOCK_SIZE)
+	{
+		std::size_t const n = std::min(BLOCK_SIZE, length - offset);
+		if (s.volumeActive)
+		{
+			s.volume.render(gains, position + offset * step, n, step);
+			for (std::size_t c = 0; c < nChannels; ++c)
+				arrayMultiply(block[c] + offset, gains, n);
+		}
+		if (s.panActive)
+		{
+			s.pan.render(gains, position + offset * step, n, step);
+			real* const left = block[0] + offset;
+			real* const right = block[1] + offset;
+			for (std::size_t j = 0; j < n; ++j)
+			{
+				left[j] *= std::min(1.0, 1.0 - gains[j]);
+				right[j] *= std::min(1.0, 1.0 + gains[j]);
+			}
+		}
+	}
+}
+
+void Automation::publish()
+{
+	settings[back] = staged;
+	back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & ~FRESH;
+}
+
+} // namespace pg
@@ -0,0 +1,95 @@
+#ifndef _POLYGAMMA_SINGULAR_AUTOMATION_HPP__
+#define _POLYGAMMA_SINGULAR_AUTOMATION_HPP__
+
+#include <atomic>
+
+#include "../core/polygamma.hpp"
+#include "../core/python.hpp"
+#include "../math/Envelope.hpp"
+
+namespace pg
+{
+
+/**
+ * The envelopes are indexed by source sample, so they follow the material
+ * rather than the output while stretching. Like the InsertChain, the
+ * envelopes are handed to the audio thread through a lock-free triple buffer,
+ * and the audio thread never allocates.
+ *
+ * @brief Volume and pan automation applied on the playback path of a
+ *  BufferSingular, ahead of its inserts.
+ */
+class Automation final
+{
+public:
+	/**
+	 * Number of samples rendered from the envelopes per lookup.
+	 */
+	static constexpr std::size_t BLOCK_SIZE = 256;
+
+	explicit Automation(std::size_t nChannels);
+
+	Automation(Automation const&) = delete;
+	Automation& operator=(Automation const&) = delete;
+
+	/**
+	 * Exposed to Python
+	 * @brief Sets the envelope of the linear gain of every channel.
+	 */
+	void setVolume(Envelope const&);
+	/**
+	 * Exposed to Python
+	 * Only available for stereo. Values lie in [-1, 1]: negative values
+	 * attenuate the right channel linearly and positive ones the left, so 0
+	 * leaves both untouched.
+	 * @brief Sets the envelope of the balance.
+	 */
+	void setPan(Envelope const&) throw(PythonException);
+	/**
+	 * Exposed to Python
+	 * @brief Removes both envelopes.
+	 */
+	void clear();
+
+	/**
+	 * @warning Must only be called from one thread (the audio thread).
+	 * @brief Applies the envelopes to the planar block in place.
+	 * @param position Source position of the first sample of the block.
+	 * @param step Source samples per sample of the block, e.g. the rate of the
+	 *  Stretcher.
+	 */
+	void process(real* const* const block, std::size_t length,
+	             std::size_t position, real step) noexcept;
+
+private:
+	struct Settings
+	{
+		bool volumeActive;
+		bool panActive;
+		Envelope volume;
+		Envelope pan;
+	};
+
+	/**
+	 * @brief Hands staged to the audio thread.
+	 */
+	void publish();
+
+	std::size_t const nChannels;
+
+	// Kernel side
+	Settings staged;
+	unsigned back;
+
+	// Shared
+	static constexpr unsigned FRESH = 4;
+	Settings settings[3];
+	std::atomic<unsigned> middle;
+
+	// Audio thread side
+	unsigned front;
+};
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_SINGULAR_AUTOMATION_HPP__
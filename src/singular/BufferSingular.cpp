@@ -1,5 +1,6 @@
 #include "BufferSingular.hpp"
 
+#include <chrono>
 #include <cstring>
 #include <iostream>
 #include <limits>
@@ -33,6 +34,7 @@ BufferSingular::~BufferSingular()
 		std::free(playdata->samples);
 		delete playdata;
 	}
+	scrubEnd();
 }
 BufferSingular* BufferSingular::fromFile(std::string fileName,
     std::string* const error) noexcept
@@ -49,8 +51,8 @@ BufferSingular* BufferSingular::fromFile(std::string fileName,
 		delete media;
 		return nullptr;
 	}
-	BufferSingular* buffer = new BufferSingular(media->channelLayout);
-	buffer->sampleRate = media->sampleRate;
+	BufferSingular* buffer = new BufferSingular(media->channelLayout,
+	                                            media->sampleRate);
 	buffer->title = fileName;
 	for (std::size_t i = 0; i < buffer->nAudioChannels(); ++i)
 	{
@@ -80,8 +82,7 @@ noexcept
 		return nullptr;
 	}
 
-	BufferSingular* buffer = new BufferSingular(cl);
-	buffer->sampleRate = sampleRate;
+	BufferSingular* buffer = new BufferSingular(cl, sampleRate);
 	buffer->title = "Untitled";
 	for (auto& channel: buffer->audio)
 		channel = Vector<real>(duration, 0.0);
@@ -119,19 +120,114 @@ void BufferSingular::play() throw(PythonException)
 		Media_init(playdata);
 		loadToMedia(playdata);
 	}
-	if (!media_open(playdata))
+	installHooks(playdata);
+	if (!media_open(playdata, 1024 * playdata->nChannels))
 	{
 		throw PythonException{"Unable to open media",
 		                      PythonException::RuntimeError};
 	}
 	Media_set_cursor(playdata, cursor);
 	media_play(playdata);
+	// Lets the editors follow the playhead
+	notifyUpdate(Update::Surface);
 }
 void BufferSingular::stop() throw(PythonException)
 {
 	Buffer::stop();
+	// Resume from what was heard, not from what was rendered ahead
+	std::size_t const position = Media_get_playhead(playdata);
 	media_stop(playdata);
-	setCursor(Media_get_cursor(playdata));
+	if (duration())
+		setCursor(std::min(position, duration() - 1));
+}
+
+bool BufferSingular::scrubBegin(real position) const noexcept
+{
+	if (scrubdata) return true;
+
+	scrubdata = new Media;
+	Media_init(scrubdata);
+	loadToMedia(scrubdata);
+	scrubdata->source = [](void* scrubber, Media const* m,
+	                       double* const* block, std::size_t length,
+	                       std::size_t* consumed)
+	{
+		*consumed = ((Scrubber*) scrubber)->render(block, length,
+		                                           (double const* const*) m->samples,
+		                                           m->nSamples);
+		return length;
+	};
+	scrubdata->sourceData = &scrubber;
+	scrubber.scrub(position, 0.0);
+	if (!media_open(scrubdata, Scrubber::DEVICE_SAMPLES))
+	{
+		std::free(scrubdata->samples);
+		delete scrubdata;
+		scrubdata = nullptr;
+		return false;
+	}
+	media_play(scrubdata);
+	return true;
+}
+void BufferSingular::scrubEnd() const noexcept
+{
+	if (!scrubdata) return;
+	media_stop(scrubdata);
+	media_close(scrubdata);
+	std::free(scrubdata->samples);
+	delete scrubdata;
+	scrubdata = nullptr;
+}
+
+BufferSingular* BufferSingular::bounce(std::size_t sampleRate,
+                                       std::string* const error) noexcept
+{
+	struct Media out;
+	Media_init(&out);
+	if (!render(&out, sampleRate, error))
+		return nullptr;
+
+	BufferSingular* buffer = BufferSingular::create(channelLayout, sampleRate,
+	                                                std::max<std::size_t>(out.nSamples, 1),
+	                                                error);
+	if (buffer)
+	{
+		buffer->title = title + " (Bounce)";
+		// Deinterleave, keeping the 16 bit quantisation
+		int16_t const* const samples = (int16_t const*) out.samples[0];
+		for (std::size_t c = 0; c < out.nChannels; ++c)
+		{
+			real* const channel = buffer->audio[c].getData();
+			for (std::size_t i = 0; i < out.nSamples; ++i)
+				channel[i] = samples[i * out.nChannels + c] / 32768.0;
+		}
+	}
+	std::free(out.samples[0]);
+	std::free(out.samples);
+	return buffer;
+}
+bool BufferSingular::bounceToFile(std::string fileName, std::size_t sampleRate,
+                                  std::string* const error) noexcept
+{
+	struct Media out;
+	Media_init(&out);
+	if (!render(&out, sampleRate, error))
+		return false;
+
+	char const* errstr = nullptr;
+	bool const success = Media_save_file(&out, fileName.c_str(), &errstr);
+	if (!success)
+		*error = std::string(errstr);
+	std::free(out.samples[0]);
+	std::free(out.samples);
+	return success;
+}
+void BufferSingular::bounceToFile(std::string fileName, std::size_t sampleRate)
+throw(PythonException)
+{
+	std::string error;
+	if (!bounceToFile(fileName, sampleRate, &error))
+		throw PythonException{error, PythonException::IOError};
 }
 
 void BufferSingular::loadToMedia(struct Media* const m) const noexcept
@@ -148,4 +244,91 @@ void BufferSingular::loadToMedia(struct Media* const m) const noexcept
 	m->nSamples = duration();
 }
 
+void BufferSingular::installHooks(struct Media* const m) noexcept
+{
+	m->source = [](void* stretcher, Media const* m,
+	               double* const* block, std::size_t length,
+	               std::size_t* consumed)
+	{
+		return ((Stretcher*) stretcher)->render(block, length,
+		                                        (double const* const*) m->samples,
+		                                        m->nSamples, m->cursor, consumed);
+	};
+	m->sourceData = &stretcher;
+	m->insert = [](void* buffer, Media const* m,
+	               double* const* block, std::size_t length,
+	               std::size_t consumed)
+	{
+		BufferSingular* const b = (BufferSingular*) buffer;
+		// The cursor has not advanced past the block yet. The envelopes follow
+		// the source, which the Stretcher may traverse at another speed
+		b->automation.process(block, length, m->cursor,
+		                      length ? (real) consumed / length : 1.0);
+		b->inserts.process(block, length, m->audioDevice != 0);
+	};
+	m->insertData = this;
+}
+bool BufferSingular::render(struct Media* const out, std::size_t sampleRate,
+                            std::string* const error) noexcept
+{
+	if (playing())
+	{
+		*error = "Unable to render while playing";
+		return false;
+	}
+	if (std::find(std::begin(SAMPLE_RATES), std::end(SAMPLE_RATES), sampleRate) ==
+	    std::end(SAMPLE_RATES))
+	{
+		*error = "Invalid sample rate";
+		return false;
+	}
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point const begin = Clock::now();
+
+	struct Media m;
+	Media_init(&m);
+	loadToMedia(&m);
+	installHooks(&m);
+	if (!media_open_offline(&m, sampleRate))
+	{
+		*error = "Unable to open media";
+		std::free(m.samples);
+		return false;
+	}
+
+	out->sampleFormat = AV_SAMPLE_FMT_S16;
+	out->channelLayout = channelLayout;
+	out->nChannels = m.nChannels;
+	out->sampleRate = sampleRate;
+	out->nSamples = 0;
+	out->samples = (uint8_t**) std::malloc(sizeof(uint8_t*));
+	out->samples[0] = nullptr;
+
+	// Grow the output geometrically, rendering a block at a time into its end
+	std::size_t const frameSize = m.nChannels * sizeof(int16_t);
+	std::size_t capacity = 0;
+	while (true)
+	{
+		if (capacity - out->nSamples < MEDIA_OFFLINE_BLOCK)
+		{
+			capacity = std::max<std::size_t>(capacity * 2, MEDIA_OFFLINE_BLOCK);
+			out->samples[0] = (uint8_t*) std::realloc(out->samples[0],
+			                                          capacity * frameSize);
+		}
+		std::size_t const n =
+		  media_render(&m, out->samples[0] + out->nSamples * frameSize,
+		               MEDIA_OFFLINE_BLOCK);
+		out->nSamples += n;
+		if (n < MEDIA_OFFLINE_BLOCK) break;
+	}
+	media_close(&m);
+	std::free(m.samples);
+
+	real const elapsed = std::chrono::duration<real>(Clock::now() - begin).count();
+	std::cout << "[Ker] Rendered " << out->nSamples << " samples in "
+	          << elapsed << "s (" << out->nSamples / (sampleRate * elapsed)
+	          << "x realtime)" << std::endl;
+	return true;
+}
+
 } // namespace pg
@@ -15,6 +15,10 @@ extern "C"
 #include "../core/polygamma.hpp"
 #include "../core/Buffer.hpp"
 #include "../math/Vector.hpp"
+#include "Automation.hpp"
+#include "InsertChain.hpp"
+#include "Scrubber.hpp"
+#include "Stretcher.hpp"
 
 namespace pg
 {
@@ -69,6 +73,59 @@ public:
 	virtual void play() throw(PythonException) override;
 	virtual void stop() throw(PythonException) override;
 	virtual bool playing() const noexcept override;
+	/**
+	 * Exposed to Python
+	 * Lock-free, so the GUI thread may follow the playback with it.
+	 * @brief The sample currently audible while playing. Equals the cursor
+	 *  otherwise.
+	 */
+	std::size_t playhead() const noexcept;
+
+	/**
+	 * Scrubbing plays through its own low latency audio device and does not
+	 * go through the Kernel, so the GUI may drive it directly from mouse
+	 * events. The buffer data is not modified. The inserts are not applied,
+	 * since they may be in use by the playback at the same time.
+	 *
+	 * @warning The scrub functions must only be called from one thread (the
+	 *  GUI thread).
+	 * @brief Opens the scrub device at the given source position.
+	 * @return false if the device cannot be opened.
+	 */
+	bool scrubBegin(real position) const noexcept;
+	/**
+	 * Lock-free.
+	 * @brief Moves the scrub position.
+	 * @param velocity Source samples per output sample.
+	 */
+	void scrub(real position, real velocity) const noexcept;
+	void scrubEnd() const noexcept;
+	bool scrubbing() const noexcept;
+
+	/**
+	 * The buffer is rendered from its beginning through the stretcher and the
+	 * inserts, resampled to sampleRate and quantised to 16 bits exactly as
+	 * during playback, but as fast as the CPU allows and without an audio
+	 * device. Cannot be used while the buffer is playing.
+	 *
+	 * @brief Renders the playback path into a new BufferSingular.
+	 * @param[out] error is filled when the rendering fails.
+	 * @return A BufferSingular object if the rendering is successiful. nullptr
+	 *  otherwise.
+	 */
+	BufferSingular* bounce(std::size_t sampleRate,
+	                       std::string* const error) noexcept;
+	/**
+	 * @brief Renders the playback path as bounce() does straight to a file.
+	 */
+	bool bounceToFile(std::string fileName, std::size_t sampleRate,
+	                  std::string* const error) noexcept;
+	/**
+	 * Exposed to Python. Wraps bool bounceToFile(std::string, std::size_t,
+	 *  std::string* const) and throws IOError upon failure.
+	 */
+	void bounceToFile(std::string fileName,
+	                  std::size_t sampleRate) throw(PythonException);
 
 	/**
 	 * Exposed to Python
@@ -82,6 +139,24 @@ public:
 	Vector<real>* audioChannel(std::size_t);
 	Vector<real> const* audioChannel(std::size_t) const;
 
+	/**
+	 * Exposed to Python
+	 * @brief The volume and pan envelopes applied during playback, ahead of
+	 *  the inserts. The buffer data is not modified by them.
+	 */
+	Automation* getAutomation() noexcept;
+	/**
+	 * Exposed to Python
+	 * @brief The realtime effects applied during playback. The buffer data is
+	 *  not modified by them.
+	 */
+	InsertChain* getInserts() noexcept;
+	/**
+	 * Exposed to Python
+	 * @brief Controls the playback speed.
+	 */
+	Stretcher* getStretcher() noexcept;
+
 	/**
 	 * Exposed to Python
 	 * @brief Sets a selection on every channel.
@@ -119,9 +194,20 @@ public:
 	IntervalIndex getSelection(std::size_t channel) const throw(PythonException);
 
 private:
-	BufferSingular();
-	BufferSingular(ChannelLayout channelLayout);
+	BufferSingular(ChannelLayout channelLayout, std::size_t sampleRate);
 	void loadToMedia(struct Media* const) const noexcept;
+	/**
+	 * @brief Installs the stretcher, the automation and the inserts as the
+	 *  hooks of the playback path.
+	 */
+	void installHooks(struct Media* const) noexcept;
+	/**
+	 * @brief Renders the playback path offline.
+	 * @param[out] out Receives the interleaved S16 samples in out->samples[0],
+	 *  which must be freed along with out->samples.
+	 */
+	bool render(struct Media* const out, std::size_t sampleRate,
+	            std::string* const error) noexcept;
 
 	std::size_t sampleRate;
 	ChannelLayout channelLayout;
@@ -131,20 +217,29 @@ private:
 	std::vector<IntervalIndex> selections;
 
 	mutable struct Media* playdata;
+	Automation automation;
+	InsertChain inserts;
+	Stretcher stretcher;
+	mutable struct Media* scrubdata;
+	mutable Scrubber scrubber;
 };
 
 
 
 // Implementations
 
-inline BufferSingular::BufferSingular(): playdata(nullptr)
-{
-}
-inline BufferSingular::BufferSingular(ChannelLayout channelLayout):
+inline BufferSingular::BufferSingular(ChannelLayout channelLayout,
+                                      std::size_t sampleRate):
+	sampleRate(sampleRate),
 	channelLayout(channelLayout),
 	audio(av_get_channel_layout_nb_channels(channelLayout)),
 	selections(audio.size()),
-	playdata(nullptr)
+	playdata(nullptr),
+	automation(audio.size()),
+	inserts(audio.size(), sampleRate),
+	stretcher(audio.size()),
+	scrubdata(nullptr),
+	scrubber(audio.size(), sampleRate)
 {
 	for (auto& selection: selections)
 		selection.begin = selection.end = 0;
@@ -177,6 +272,24 @@ BufferSingular::playing() const noexcept
 	return playdata && playdata->playing;
 }
 inline std::size_t
+BufferSingular::playhead() const noexcept
+{
+	if (scrubbing())
+		return (std::size_t) std::max(0.0, std::min(scrubber.getPosition(),
+		                                            (real) duration() - 1));
+	return playing() ? Media_get_playhead(playdata) : cursor;
+}
+inline void
+BufferSingular::scrub(real position, real velocity) const noexcept
+{
+	scrubber.scrub(position, velocity);
+}
+inline bool
+BufferSingular::scrubbing() const noexcept
+{
+	return scrubdata;
+}
+inline std::size_t
 BufferSingular::nAudioChannels() const noexcept
 {
 	return audio.size();
@@ -197,6 +310,21 @@ BufferSingular::audioChannel(std::size_t index) const
 {
 	return &audio[index];
 }
+inline Automation*
+BufferSingular::getAutomation() noexcept
+{
+	return &automation;
+}
+inline InsertChain*
+BufferSingular::getInserts() noexcept
+{
+	return &inserts;
+}
+inline Stretcher*
+BufferSingular::getStretcher() noexcept
+{
+	return &stretcher;
+}
 inline void
 BufferSingular::select(std::size_t begin, std::size_t end)
 throw(PythonException)
@@ -0,0 +1,447 @@
+#include "FingerprintIndex.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace pg
+{
+
+/**
+ * @brief Reads size bytes from position.
+ */
+void readAt(std::FILE* const, std::uint64_t position, void* const data,
+            std::size_t size) throw(PythonException);
+void writeAll(std::FILE* const, void const* const data, std::size_t size)
+throw(PythonException);
+
+// Implementations
+
+constexpr std::uint32_t FingerprintIndex::VERSION;
+constexpr std::size_t FingerprintIndex::PREFIX_BITS;
+constexpr std::size_t FingerprintIndex::SUFFIX_BITS;
+constexpr std::size_t FingerprintIndex::RECORD_SIZE;
+constexpr std::size_t FingerprintIndex::SMALL_BUCKET;
+constexpr std::size_t FingerprintIndex::SEGMENT_RECORDS;
+constexpr std::size_t FingerprintIndex::MIN_SCORE;
+
+void readAt(std::FILE* const file, std::uint64_t position, void* const data,
+            std::size_t size) throw(PythonException)
+{
+	if (std::fseek(file, (long) position, SEEK_SET) ||
+	    std::fread(data, 1, size, file) != size)
+		throw PythonException{"Unable to read the fingerprint index",
+		                      PythonException::IOError};
+}
+void writeAll(std::FILE* const file, void const* const data, std::size_t size)
+throw(PythonException)
+{
+	if (size && std::fwrite(data, 1, size, file) != size)
+		throw PythonException{"Unable to write the fingerprint index",
+		                      PythonException::IOError};
+}
+
+FingerprintIndex::FingerprintIndex():
+	sorted(true)
+{
+}
+FingerprintIndex::FingerprintIndex(std::string path) throw(PythonException):
+	sorted(true)
+{
+	segment s{std::fopen(path.c_str(), "rb"), 0, {}};
+	if (!s.file)
+		throw PythonException{"Unable to open " + path,
+		                      PythonException::IOError};
+	try
+	{
+		PythonException const corrupt{"Corrupt fingerprint index: " + path,
+		                              PythonException::IOError};
+		long const end = std::fseek(s.file, 0, SEEK_END) ? -1 : std::ftell(s.file);
+		if (end < 0)
+			throw corrupt;
+		std::uint64_t const size = end;
+		std::uint64_t position = 0;
+		auto const get = [&](void* const data, std::size_t n)
+		{
+			if (n > size - position)
+				throw corrupt;
+			readAt(s.file, position, data, n);
+			position += n;
+		};
+
+		char magic[4];
+		std::uint32_t version, n;
+		if (size < sizeof(magic) + sizeof(version) + sizeof(n))
+			throw corrupt;
+		get(magic, 4);
+		get(&version, sizeof(version));
+		get(&n, sizeof(n));
+		if (std::memcmp(magic, "PGFP", 4) || version != VERSION)
+			throw PythonException{"Not a fingerprint index: " + path,
+			                      PythonException::IOError};
+		// Every track takes at least its name length and hop
+		if (n > (size - position) / (sizeof(std::uint32_t) + sizeof(real)))
+			throw corrupt;
+		tracks.reserve(n);
+		for (std::uint32_t i = 0; i < n; ++i)
+		{
+			std::uint32_t length;
+			get(&length, sizeof(length));
+			if (length > size - position)
+				throw corrupt;
+			track t;
+			t.name.resize(length);
+			get(&t.name[0], length);
+			get(&t.hop, sizeof(t.hop));
+			tracks.push_back(std::move(t));
+		}
+		s.directory.resize((1 << PREFIX_BITS) + 1);
+		get(s.directory.data(), s.directory.size() * sizeof(std::uint64_t));
+		s.offset = position;
+		if (s.directory.front() != 0 ||
+		    !std::is_sorted(s.directory.begin(), s.directory.end()) ||
+		    s.directory.back() != size - s.offset)
+			throw corrupt;
+	}
+	catch (...)
+	{
+		std::fclose(s.file);
+		throw;
+	}
+	segments.push_back(std::move(s));
+}
+FingerprintIndex::~FingerprintIndex()
+{
+	for (auto const& s: segments)
+		std::fclose(s.file);
+}
+
+void FingerprintIndex::add(BufferSingular const* buffer, std::string name)
+throw(PythonException)
+{
+	std::vector<real const*> channels;
+	for (std::size_t i = 0; i < buffer->nAudioChannels(); ++i)
+		channels.push_back(buffer->audioChannel(i)->getData());
+	real const sampleRate = buffer->timeBase();
+	std::vector<landmark> const landmarks =
+	  fingerprint(channels.data(), channels.size(), buffer->duration(),
+	              sampleRate);
+
+	std::uint32_t const id = tracks.size();
+	tracks.push_back(track{name.empty() ? buffer->getTitle() : name,
+	                       fingerprintHop(sampleRate) / sampleRate});
+	for (auto const& l: landmarks)
+		records.push_back(record{l.hash, id, l.time});
+	sorted = landmarks.empty() && sorted;
+	if (records.size() < SEGMENT_RECORDS)
+		return;
+
+	segment s{std::tmpfile(), 0, {}};
+	if (!s.file)
+		throw PythonException{"Unable to create a temporary file",
+		                      PythonException::IOError};
+	try
+	{
+		writeBuckets(s.file, {}, &s.directory);
+	}
+	catch (...)
+	{
+		std::fclose(s.file);
+		throw;
+	}
+	segments.push_back(std::move(s));
+	records.clear();
+}
+void FingerprintIndex::save(std::string path) throw(PythonException)
+{
+	std::string const temporary = path + ".tmp";
+	segment s{std::fopen(temporary.c_str(), "wb"), 0, {}};
+	if (!s.file)
+		throw PythonException{"Unable to write " + path,
+		                      PythonException::IOError};
+	try
+	{
+		std::uint32_t const version = VERSION;
+		std::uint32_t const n = tracks.size();
+		writeAll(s.file, "PGFP", 4);
+		writeAll(s.file, &version, sizeof(version));
+		writeAll(s.file, &n, sizeof(n));
+		for (auto const& t: tracks)
+		{
+			std::uint32_t const length = t.name.size();
+			writeAll(s.file, &length, sizeof(length));
+			writeAll(s.file, t.name.data(), length);
+			writeAll(s.file, &t.hop, sizeof(t.hop));
+		}
+		// The directory is known once the buckets are written
+		std::uint64_t const directoryOffset = std::ftell(s.file);
+		s.offset = directoryOffset +
+		           ((1 << PREFIX_BITS) + 1) * sizeof(std::uint64_t);
+		if (std::fseek(s.file, (long) s.offset, SEEK_SET))
+			throw PythonException{"Unable to write the fingerprint index",
+			                      PythonException::IOError};
+		writeBuckets(s.file, segments, &s.directory);
+		if (std::fseek(s.file, (long) directoryOffset, SEEK_SET))
+			throw PythonException{"Unable to write the fingerprint index",
+			                      PythonException::IOError};
+		writeAll(s.file, s.directory.data(),
+		         s.directory.size() * sizeof(std::uint64_t));
+	}
+	catch (...)
+	{
+		std::fclose(s.file);
+		std::remove(temporary.c_str());
+		throw;
+	}
+	if (std::fclose(s.file) || std::rename(temporary.c_str(), path.c_str()))
+	{
+		std::remove(temporary.c_str());
+		throw PythonException{"Unable to write " + path,
+		                      PythonException::IOError};
+	}
+
+	// Every record is now in path, with the directory just written
+	s.file = std::fopen(path.c_str(), "rb");
+	if (!s.file)
+		throw PythonException{"Unable to open " + path,
+		                      PythonException::IOError};
+	for (auto const& old: segments)
+		std::fclose(old.file);
+	segments.clear();
+	segments.push_back(std::move(s));
+	records.clear();
+	records.shrink_to_fit();
+	sorted = true;
+}
+
+std::vector<FingerprintIndex::Match>
+FingerprintIndex::query(BufferSingular const* buffer) throw(PythonException)
+{
+	IntervalIndex range(std::numeric_limits<std::size_t>::max(), 0);
+	for (std::size_t i = 0; i < buffer->nAudioChannels(); ++i)
+	{
+		IntervalIndex const selection = buffer->getSelection(i);
+		if (!isEmpty(selection))
+			range += selection;
+	}
+	if (isEmpty(range))
+		throw PythonException{"The selection is empty",
+		                      PythonException::ValueError};
+
+	std::vector<real const*> channels;
+	for (std::size_t i = 0; i < buffer->nAudioChannels(); ++i)
+		channels.push_back(buffer->audioChannel(i)->getData() + range.begin);
+	std::vector<landmark> landmarks =
+	  fingerprint(channels.data(), channels.size(), range.end - range.begin,
+	              buffer->timeBase());
+	auto const byHash = [](landmark const& a, landmark const& b)
+	{
+		return a.hash < b.hash;
+	};
+	std::sort(landmarks.begin(), landmarks.end(), byHash);
+
+	// Votes by track and offset in frames
+	std::unordered_map<std::uint64_t, std::uint32_t> votes;
+	auto const vote = [&](record const& r)
+	{
+		auto const matches = std::equal_range(landmarks.begin(), landmarks.end(),
+		                                      landmark{r.hash, 0}, byHash);
+		for (auto l = matches.first; l != matches.second; ++l)
+			++votes[(std::uint64_t) r.track << 32 | (std::uint32_t) (r.time - l->time)];
+	};
+
+	sortRecords();
+	for (std::size_t i = 0; i < landmarks.size(); )
+	{
+		std::uint32_t const hash = landmarks[i].hash;
+		auto const matches = std::equal_range(records.begin(), records.end(),
+		                                      record{hash, 0, 0},
+		                                      [](record const& a, record const& b)
+		{
+			return a.hash < b.hash;
+		});
+		std::for_each(matches.first, matches.second, vote);
+		while (i < landmarks.size() && landmarks[i].hash == hash)
+			++i;
+	}
+
+	// Landmarks sharing a prefix share a bucket of every segment
+	std::vector<record> bucket;
+	std::vector<std::uint32_t> suffixes((1 << SUFFIX_BITS) + 1);
+	for (auto const& s: segments)
+		for (std::size_t i = 0; i < landmarks.size(); )
+		{
+			std::size_t const prefix = landmarks[i].hash >> SUFFIX_BITS;
+			std::size_t end = i;
+			while (end < landmarks.size() &&
+			       landmarks[end].hash >> SUFFIX_BITS == prefix)
+				++end;
+
+			std::uint64_t position;
+			std::uint64_t const n = bucketSize(s, prefix, &position);
+			bucket.clear();
+			if (n <= SMALL_BUCKET)
+				readBucket(s, prefix, &bucket);
+			else
+			{
+				// Only the records of the hashes of the landmarks
+				readAt(s.file, s.offset + position - suffixes.size() *
+				       sizeof(std::uint32_t), suffixes.data(),
+				       suffixes.size() * sizeof(std::uint32_t));
+				if (suffixes.front() != 0 || suffixes.back() != n ||
+				    !std::is_sorted(suffixes.begin(), suffixes.end()))
+					throw PythonException{"Corrupt fingerprint index",
+					                      PythonException::IOError};
+				for (std::size_t j = i; j < end; )
+				{
+					std::uint32_t const hash = landmarks[j].hash;
+					std::size_t const suffix = hash & ((1 << SUFFIX_BITS) - 1);
+					readRecords(s, prefix,
+					            position + suffixes[suffix] * RECORD_SIZE,
+					            suffixes[suffix + 1] - suffixes[suffix], &bucket);
+					while (j < end && landmarks[j].hash == hash)
+						++j;
+				}
+			}
+			std::for_each(bucket.begin(), bucket.end(), vote);
+			i = end;
+		}
+
+	// The best offset of every track
+	std::vector<std::pair<std::uint32_t, std::int32_t>> best(tracks.size(),
+	    std::make_pair(0, 0));
+	for (auto const& v: votes)
+	{
+		auto& b = best[v.first >> 32];
+		if (v.second > b.first)
+			b = std::make_pair(v.second, (std::int32_t) (std::uint32_t) v.first);
+	}
+	std::vector<Match> result;
+	for (std::size_t i = 0; i < tracks.size(); ++i)
+		if (best[i].first >= MIN_SCORE)
+			result.push_back(Match{tracks[i].name, best[i].second * tracks[i].hop,
+			                       best[i].first});
+	std::sort(result.begin(), result.end(), [](Match const& a, Match const& b)
+	{
+		return a.score > b.score;
+	});
+	return result;
+}
+
+void FingerprintIndex::sortRecords()
+{
+	if (sorted)
+		return;
+	std::sort(records.begin(), records.end(), [](record const& a, record const& b)
+	{
+		return a.hash != b.hash ? a.hash < b.hash :
+		       a.track != b.track ? a.track < b.track : a.time < b.time;
+	});
+	sorted = true;
+}
+void FingerprintIndex::writeBuckets(std::FILE* const file,
+                                    std::vector<segment> const& sources,
+                                    std::vector<std::uint64_t>* const directory)
+throw(PythonException)
+{
+	sortRecords();
+	directory->assign((1 << PREFIX_BITS) + 1, 0);
+	std::vector<record> bucket;
+	std::vector<std::uint32_t> suffixes((1 << SUFFIX_BITS) + 1);
+	std::vector<char> data;
+	auto r = records.begin();
+	for (std::size_t prefix = 0; prefix < (1 << PREFIX_BITS); ++prefix)
+	{
+		// Every source holds distinct tracks, so the merge only orders hashes
+		bucket.clear();
+		for (auto const& s: sources)
+			readBucket(s, prefix, &bucket);
+		for (; r != records.end() && r->hash >> SUFFIX_BITS == prefix; ++r)
+			bucket.push_back(*r);
+		std::sort(bucket.begin(), bucket.end(),
+		          [](record const& a, record const& b)
+		{
+			return a.hash != b.hash ? a.hash < b.hash :
+			       a.track != b.track ? a.track < b.track : a.time < b.time;
+		});
+
+		std::uint64_t size = bucket.size() * RECORD_SIZE;
+		if (bucket.size() > SMALL_BUCKET)
+		{
+			std::fill(suffixes.begin(), suffixes.end(), 0);
+			for (auto const& b: bucket)
+				++suffixes[(b.hash & ((1 << SUFFIX_BITS) - 1)) + 1];
+			for (std::size_t i = 1; i < suffixes.size(); ++i)
+				suffixes[i] += suffixes[i - 1];
+			writeAll(file, suffixes.data(),
+			         suffixes.size() * sizeof(std::uint32_t));
+			size += suffixes.size() * sizeof(std::uint32_t);
+		}
+		data.resize(bucket.size() * RECORD_SIZE);
+		char* p = data.data();
+		for (auto const& b: bucket)
+		{
+			p[0] = (char) (b.hash & ((1 << SUFFIX_BITS) - 1));
+			std::memcpy(p + 1, &b.track, sizeof(b.track));
+			std::memcpy(p + 5, &b.time, sizeof(b.time));
+			p += RECORD_SIZE;
+		}
+		writeAll(file, data.data(), data.size());
+		(*directory)[prefix + 1] = (*directory)[prefix] + size;
+	}
+}
+
+std::uint64_t FingerprintIndex::bucketSize(segment const& s,
+                                           std::size_t prefix,
+                                           std::uint64_t* const position) const
+throw(PythonException)
+{
+	*position = s.directory[prefix];
+	std::uint64_t size = s.directory[prefix + 1] - s.directory[prefix];
+	std::uint64_t const index = ((1 << SUFFIX_BITS) + 1) * sizeof(std::uint32_t);
+	if (size > SMALL_BUCKET * RECORD_SIZE)
+	{
+		if (size < index)
+			throw PythonException{"Corrupt fingerprint index",
+			                      PythonException::IOError};
+		*position += index;
+		size -= index;
+	}
+	if (size % RECORD_SIZE)
+		throw PythonException{"Corrupt fingerprint index",
+		                      PythonException::IOError};
+	return size / RECORD_SIZE;
+}
+void FingerprintIndex::readBucket(segment const& s, std::size_t prefix,
+                                  std::vector<record>* const out) const
+throw(PythonException)
+{
+	std::uint64_t position;
+	std::uint64_t const n = bucketSize(s, prefix, &position);
+	readRecords(s, prefix, position, n, out);
+}
+void FingerprintIndex::readRecords(segment const& s, std::size_t prefix,
+                                   std::uint64_t position, std::uint64_t count,
+                                   std::vector<record>* const out) const
+throw(PythonException)
+{
+	if (count == 0)
+		return;
+	std::vector<char> data(count * RECORD_SIZE);
+	readAt(s.file, s.offset + position, data.data(), data.size());
+
+	char const* p = data.data();
+	for (std::uint64_t i = 0; i < count; ++i, p += RECORD_SIZE)
+	{
+		record r;
+		r.hash = (std::uint32_t) prefix << SUFFIX_BITS | (unsigned char) p[0];
+		std::memcpy(&r.track, p + 1, sizeof(r.track));
+		std::memcpy(&r.time, p + 5, sizeof(r.time));
+		if (r.track >= tracks.size())
+			throw PythonException{"Corrupt fingerprint index",
+			                      PythonException::IOError};
+		out->push_back(r);
+	}
+}
+
+} // namespace pg
@@ -0,0 +1,180 @@
+#ifndef _POLYGAMMA_SINGULAR_FINGERPRINTINDEX_HPP__
+#define _POLYGAMMA_SINGULAR_FINGERPRINTINDEX_HPP__
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "BufferSingular.hpp"
+#include "../core/python.hpp"
+#include "../math/fingerprint.hpp"
+
+namespace pg
+{
+
+/**
+ * Tracks added since the index was opened are held in memory, and moved to a
+ * temporary segment file every SEGMENT_RECORDS records. The opened file and
+ * the segments keep only their directories in memory: a query reads the
+ * records of its hashes, and save() merges them a bucket at a time.
+ *
+ * File layout, in native byte order:
+ * - "PGFP", then the version and the number of tracks as uint32.
+ * - Every track: the length of its name as uint32, the name, and the
+ *   duration of its frames in seconds as a double.
+ * - The directory: 2^PREFIX_BITS + 1 uint64 offsets, in bytes from its end,
+ *   of the bucket of each prefix (the upper PREFIX_BITS bits of a hash).
+ * - The buckets. One of more than SMALL_BUCKET records starts with the
+ *   offsets, in records, of every suffix (the rest of the hash) as uint32,
+ *   and the number of records. Then the records sorted by hash,
+ *   RECORD_SIZE bytes each: the suffix as uint8, the track and the frame as
+ *   uint32.
+ *
+ * A query votes for the offset between its landmarks and the matching
+ * landmarks of every track. Landmarks of the same audio agree on one offset,
+ * while chance matches scatter, so the tally of the best offset is the score.
+ *
+ * @brief Inverted index from landmark hashes to tracks, for finding where a
+ *  clip occurs in a library.
+ */
+class FingerprintIndex final
+{
+public:
+	struct Match
+	{
+		std::string name;
+		real offset; // Seconds from the start of the track to the query
+		std::size_t score; // Landmarks which agree on the offset
+	};
+
+	static constexpr std::uint32_t VERSION = 2;
+	static constexpr std::size_t PREFIX_BITS = 16;
+	static constexpr std::size_t SUFFIX_BITS = FINGERPRINT_HASH_BITS -
+	                                           PREFIX_BITS;
+	static constexpr std::size_t RECORD_SIZE = 9;
+	/**
+	 * Larger buckets are indexed by suffix, smaller ones are read whole.
+	 */
+	static constexpr std::size_t SMALL_BUCKET = 256;
+	/**
+	 * Records of the tracks in memory at most, about an hour of audio.
+	 */
+	static constexpr std::size_t SEGMENT_RECORDS = 1 << 22;
+	/**
+	 * Matches with fewer agreeing landmarks are discarded.
+	 */
+	static constexpr std::size_t MIN_SCORE = 5;
+
+	/**
+	 * Exposed to Python
+	 * @brief Creates an empty index.
+	 */
+	FingerprintIndex();
+	/**
+	 * Exposed to Python
+	 * @brief Opens an index saved by save().
+	 */
+	explicit FingerprintIndex(std::string path) throw(PythonException);
+
+	~FingerprintIndex();
+
+	FingerprintIndex(FingerprintIndex const&) = delete;
+	FingerprintIndex& operator=(FingerprintIndex const&) = delete;
+
+	/**
+	 * Exposed to Python
+	 * @brief Fingerprints the whole buffer and adds it as a track.
+	 * @param[in] name Reported by queries. The title of the buffer if empty.
+	 */
+	void add(BufferSingular const*, std::string name) throw(PythonException);
+	/**
+	 * Exposed to Python
+	 * The file is written beside path and renamed over it, so path may be
+	 * the opened file. The index then reads from path and holds no records
+	 * in memory.
+	 * @brief Writes every track to path.
+	 */
+	void save(std::string path) throw(PythonException);
+	/**
+	 * Exposed to Python
+	 * The channels are summed over the union of their selections.
+	 * @brief Finds the tracks in which the selection occurs, best first.
+	 */
+	std::vector<Match> query(BufferSingular const*) throw(PythonException);
+	/**
+	 * Exposed to Python
+	 */
+	std::size_t nTracks() const noexcept;
+
+private:
+	struct record
+	{
+		std::uint32_t hash;
+		std::uint32_t track;
+		std::uint32_t time;
+	};
+	struct track
+	{
+		std::string name;
+		real hop; // Seconds per frame
+	};
+
+	/**
+	 * @brief Buckets sorted by hash, laid out as in the file: the opened
+	 *  file, or a segment of the tracks added since.
+	 */
+	struct segment
+	{
+		std::FILE* file;
+		std::uint64_t offset; // Of the first bucket within the file
+		std::vector<std::uint64_t> directory;
+	};
+
+	void sortRecords();
+	/**
+	 * @brief Writes the buckets of sources merged with the records in memory
+	 *  at the position of file, and their directory to directory.
+	 */
+	void writeBuckets(std::FILE* const file,
+	                  std::vector<segment> const& sources,
+	                  std::vector<std::uint64_t>* const directory)
+	throw(PythonException);
+	/**
+	 * @return The number of records of a bucket.
+	 * @param[out] position Of the first record, past the suffix offsets.
+	 */
+	std::uint64_t bucketSize(segment const&, std::size_t prefix,
+	                         std::uint64_t* const position) const
+	throw(PythonException);
+	/**
+	 * @brief Appends every record of a bucket to out.
+	 */
+	void readBucket(segment const&, std::size_t prefix,
+	                std::vector<record>* const out) const throw(PythonException);
+	/**
+	 * @brief Appends count records from position in a bucket to out.
+	 */
+	void readRecords(segment const&, std::size_t prefix,
+	                 std::uint64_t position, std::uint64_t count,
+	                 std::vector<record>* const out) const
+	throw(PythonException);
+
+	std::vector<track> tracks;
+
+	std::vector<segment> segments; // The opened file first, if any
+	std::vector<record> records; // Of the tracks in memory
+	bool sorted;
+};
+
+
+// Implementations
+
+inline std::size_t FingerprintIndex::nTracks() const noexcept
+{
+	return tracks.size();
+}
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_SINGULAR_FINGERPRINTINDEX_HPP__
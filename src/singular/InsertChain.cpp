@@ -0,0 +1,245 @@
+#include "InsertChain.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "../math/arithmetic.hpp"
+
+namespace pg
+{
+
+constexpr std::size_t InsertChain::N_SLOTS;
+constexpr std::size_t InsertChain::BLOCK_SIZE;
+
+InsertChain::InsertChain(std::size_t nChannels, std::size_t sampleRate):
+	nChannels(nChannels), sampleRate(sampleRate),
+	back(0), middle(1), loadLast(0.0), loadPeak(0.0), overruns(0),
+	front(2),
+	equalisers(N_SLOTS, BiquadBank(nChannels, {BIQUAD_IDENTITY}))
+{
+	for (auto& slot: staged.slots)
+	{
+		slot.type = Bypass;
+		slot.generation = 0;
+		slot.filter = BIQUAD_IDENTITY;
+		slot.gain = 1.0;
+		slot.ceiling = 1.0;
+		slot.release = 0.0;
+	}
+	staged.budget = 0.5;
+	for (auto& s: settings)
+		s = staged;
+	for (std::size_t i = 0; i < N_SLOTS; ++i)
+	{
+		generations[i] = 0;
+		gains[i] = 1.0;
+	}
+}
+
+void InsertChain::clear(std::size_t slot) throw(PythonException)
+{
+	checkSlot(slot);
+	staged.slots[slot].type = Bypass;
+	++staged.slots[slot].generation;
+	publish();
+}
+void InsertChain::setGain(std::size_t slot, real gainDB) throw(PythonException)
+{
+	checkSlot(slot);
+	Slot& s = staged.slots[slot];
+	if (s.type != Gain)
+	{
+		s.type = Gain;
+		++s.generation;
+	}
+	s.gain = std::pow(10.0, gainDB / 20);
+	publish();
+}
+void InsertChain::setEQ(std::size_t slot, std::string shape,
+                        real frequency, real q, real gainDB)
+throw(PythonException)
+{
+	checkSlot(slot);
+	if (!(frequency > 0.0 && frequency < sampleRate * 0.5))
+		throw PythonException{"Frequency must lie between 0 and the Nyquist frequency",
+		                      PythonException::ValueError};
+	if (!(q > 0.0))
+		throw PythonException{"Q must be positive", PythonException::ValueError};
+
+	biquad filter;
+	if (!biquadShape(&filter, shape, frequency, q, gainDB, sampleRate))
+		throw PythonException{"Unknown filter shape: " + shape,
+		                      PythonException::ValueError};
+
+	Slot& s = staged.slots[slot];
+	// Retuning a filter keeps its memory to avoid clicks
+	if (s.type != EQ)
+	{
+		s.type = EQ;
+		++s.generation;
+	}
+	s.filter = filter;
+	publish();
+}
+void InsertChain::setLimiter(std::size_t slot, real ceilingDB,
+                             real releaseMS) throw(PythonException)
+{
+	checkSlot(slot);
+	if (!(releaseMS > 0.0))
+		throw PythonException{"Release time must be positive",
+		                      PythonException::ValueError};
+	Slot& s = staged.slots[slot];
+	if (s.type != Limiter)
+	{
+		s.type = Limiter;
+		++s.generation;
+	}
+	s.ceiling = std::pow(10.0, ceilingDB / 20);
+	s.release = std::exp(-1000.0 / (releaseMS * sampleRate));
+	publish();
+}
+void InsertChain::setBudget(real budget) throw(PythonException)
+{
+	if (!(budget > 0.0 && budget <= 1.0))
+		throw PythonException{"Budget must lie in ]0, 1]",
+		                      PythonException::ValueError};
+	staged.budget = budget;
+	publish();
+}
+
+InsertChain::Load InsertChain::load() noexcept
+{
+	return Load{loadLast.load(std::memory_order_relaxed),
+	            loadPeak.exchange(0.0, std::memory_order_relaxed),
+	            overruns.load(std::memory_order_relaxed)};
+}
+
+void InsertChain::process(real* const* const block,
+                          std::size_t length, bool realtime) noexcept
+{
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point const begin = Clock::now();
+
+	// Acquire the latest settings, if any
+	if (middle.load(std::memory_order_relaxed) & FRESH)
+		front = middle.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+	Settings const& s = settings[front];
+
+	real const realTime = length / sampleRate; // Seconds
+	Clock::duration const budget =
+	  std::chrono::duration_cast<Clock::duration>(
+	    std::chrono::duration<real>(s.budget * realTime));
+
+	bool overrun = false;
+	for (std::size_t i = 0; i < N_SLOTS; ++i)
+	{
+		Slot const& slot = s.slots[i];
+		if (slot.generation != generations[i])
+		{
+			// The processor was replaced. Reset its memory.
+			generations[i] = slot.generation;
+			equalisers[i].reset();
+			gains[i] = slot.type == Gain ? slot.gain : 1.0;
+		}
+		if (slot.type == Bypass) continue;
+		/*
+		 * Past the budget only the filters are shed. Gains and limiters are cheap
+		 * and keep the level, and their state, where it should be. A shed filter
+		 * forgets its memory so that it resumes cleanly.
+		 */
+		if (overrun && slot.type == EQ)
+		{
+			equalisers[i].reset();
+			continue;
+		}
+
+		switch (slot.type)
+		{
+		case Gain:
+			processGain(slot, i, block, length);
+			break;
+		case EQ:
+			equalisers[i].setSection(0, slot.filter);
+			equalisers[i].process(block, length);
+			break;
+		case Limiter:
+			processLimiter(slot, i, block, length);
+			break;
+		default:
+			break;
+		}
+		// Shed the rest of the chain rather than starving the device
+		if (realtime && Clock::now() - begin > budget)
+			overrun = true;
+	}
+
+	real const cost = std::chrono::duration<real>(Clock::now() - begin).count()
+	                  / realTime;
+	loadLast.store(cost, std::memory_order_relaxed);
+	real peak = loadPeak.load(std::memory_order_relaxed);
+	while (cost > peak &&
+	       !loadPeak.compare_exchange_weak(peak, cost, std::memory_order_relaxed));
+	if (overrun)
+		overruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+void InsertChain::checkSlot(std::size_t slot) const throw(PythonException)
+{
+	if (slot >= N_SLOTS)
+		throw PythonException{"Insert slot out of range",
+		                      PythonException::IndexError};
+}
+void InsertChain::publish() noexcept
+{
+	settings[back] = staged;
+	back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & ~FRESH;
+}
+
+void InsertChain::processGain(Slot const& s, std::size_t slot,
+                              real* const* const block,
+                              std::size_t length) noexcept
+{
+	// Ramp across the block to avoid zipper noise upon parameter changes
+	real const g0 = gains[slot];
+	real const step = (s.gain - g0) / length;
+	for (std::size_t c = 0; c < nChannels; ++c)
+		arrayRamp(block[c], length, g0 + step, step);
+	gains[slot] = s.gain;
+}
+void InsertChain::processLimiter(Slot const& s, std::size_t slot,
+                                 real* const* const block,
+                                 std::size_t length) noexcept
+{
+	real envelope[BLOCK_SIZE];
+	real g = gains[slot];
+	for (std::size_t offset = 0; offset < length; offset += BLOCK_SIZE)
+	{
+		std::size_t const n = std::min(BLOCK_SIZE, length - offset);
+
+		// Nothing to do below the ceiling once the gain has recovered
+		real peak = 0.0;
+		for (std::size_t c = 0; c < nChannels; ++c)
+			peak = std::max(peak, arrayPeak(block[c] + offset, n));
+		if (peak <= s.ceiling && g == 1.0)
+			continue;
+
+		// Linked detection: Peak across all channels
+		std::fill(envelope, envelope + n, 0.0);
+		for (std::size_t c = 0; c < nChannels; ++c)
+			arrayPeaks(envelope, block[c] + offset, n);
+		// Gain computer. Instant attack, exponential release.
+		for (std::size_t j = 0; j < n; ++j)
+		{
+			real const target = envelope[j] > s.ceiling ?
+			                    s.ceiling / envelope[j] : 1.0;
+			g = target < g ? target : target + (g - target) * s.release;
+			envelope[j] = g;
+		}
+		for (std::size_t c = 0; c < nChannels; ++c)
+			arrayMultiply(block[c] + offset, envelope, n);
+	}
+	gains[slot] = g;
+}
+
+} // namespace pg
@@ -0,0 +1,171 @@
+#ifndef _POLYGAMMA_SINGULAR_INSERTCHAIN_HPP__
+#define _POLYGAMMA_SINGULAR_INSERTCHAIN_HPP__
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "../core/polygamma.hpp"
+#include "../core/python.hpp"
+#include "../math/BiquadBank.hpp"
+
+namespace pg
+{
+
+/**
+ * The chain has a fixed number of slots which are processed in order. The
+ * parameters are edited by the Kernel thread and handed to the audio thread
+ * through a lock-free triple buffer, so neither side ever blocks the other.
+ *
+ * process() measures its own cost. Once a block has used up the budget, the
+ * remaining EQ slots are bypassed for that block and an overrun is recorded.
+ * Gain and Limiter slots always run, so the ceiling of a limiter holds under
+ * load.
+ *
+ * @brief Realtime insert effects applied on the playback path of a
+ *  BufferSingular.
+ */
+class InsertChain final
+{
+public:
+	static constexpr std::size_t N_SLOTS = 8;
+
+	enum Type
+	{
+		Bypass,
+		Gain,
+		EQ,
+		Limiter
+	};
+	/**
+	 * All durations are fractions of the real time taken by the processed
+	 * blocks, i.e. 1.0 means the chain is exactly as slow as playback.
+	 * @brief Cost of the chain as measured on the audio thread.
+	 */
+	struct Load
+	{
+		real last;
+		real peak;
+		std::size_t overruns;
+	};
+
+	InsertChain(std::size_t nChannels, std::size_t sampleRate);
+
+	InsertChain(InsertChain const&) = delete;
+	InsertChain& operator=(InsertChain const&) = delete;
+
+	/**
+	 * Exposed to Python
+	 * @brief Removes the processor in the given slot.
+	 */
+	void clear(std::size_t slot) throw(PythonException);
+	/**
+	 * Exposed to Python
+	 */
+	void setGain(std::size_t slot, real gainDB) throw(PythonException);
+	/**
+	 * Exposed to Python
+	 * @param shape One of "lowpass", "highpass", "peak", "lowshelf",
+	 *  "highshelf".
+	 */
+	void setEQ(std::size_t slot, std::string shape,
+	           real frequency, real q, real gainDB) throw(PythonException);
+	/**
+	 * Exposed to Python
+	 * The limiter is linked across channels: every channel receives the gain
+	 * computed from the loudest one.
+	 * @param ceilingDB The peak level that will not be exceeded.
+	 * @param releaseMS Time needed for the gain to recover by 1/e.
+	 */
+	void setLimiter(std::size_t slot, real ceilingDB,
+	                real releaseMS) throw(PythonException);
+	/**
+	 * Exposed to Python
+	 * @brief Fraction of the real time of a callback that the chain may spend.
+	 */
+	real getBudget() const noexcept;
+	void setBudget(real) throw(PythonException);
+
+	/**
+	 * Exposed to Python
+	 * @brief Obtains the measured cost and resets the peak.
+	 */
+	Load load() noexcept;
+
+	/**
+	 * @warning Must only be called from one thread (the audio thread).
+	 * @brief Applies every active slot to the planar block in place.
+	 * @param realtime If false (offline rendering), no slot is ever bypassed
+	 *  for exceeding the budget.
+	 */
+	void process(real* const* const block, std::size_t length,
+	             bool realtime = true) noexcept;
+
+private:
+	struct Slot
+	{
+		Type type;
+		/*
+		 * Incremented whenever the processor in the slot is replaced, so the
+		 * audio thread knows when to reset the processor state.
+		 */
+		unsigned generation;
+		biquad filter;
+		real gain; // Gain: Linear gain
+		real ceiling; // Limiter: Linear ceiling
+		real release; // Limiter: Per sample recovery coefficient
+	};
+	struct Settings
+	{
+		Slot slots[N_SLOTS];
+		real budget;
+	};
+
+	void checkSlot(std::size_t slot) const throw(PythonException);
+	/**
+	 * @brief Hands staged to the audio thread.
+	 */
+	void publish() noexcept;
+
+	void processGain(Slot const&, std::size_t slot,
+	                 real* const* const block, std::size_t length) noexcept;
+	void processLimiter(Slot const&, std::size_t slot,
+	                    real* const* const block, std::size_t length) noexcept;
+
+	std::size_t const nChannels;
+	real const sampleRate;
+
+	// Kernel side
+	Settings staged;
+	unsigned back;
+
+	// Shared
+	static constexpr unsigned FRESH = 4;
+	Settings settings[3];
+	std::atomic<unsigned> middle;
+	std::atomic<real> loadLast;
+	std::atomic<real> loadPeak;
+	std::atomic<std::size_t> overruns;
+
+	// Audio thread side
+	/**
+	 * Length of the scratch envelope used by the limiter.
+	 */
+	static constexpr std::size_t BLOCK_SIZE = 256;
+	unsigned front;
+	unsigned generations[N_SLOTS];
+	std::vector<BiquadBank> equalisers; // One section per slot
+	real gains[N_SLOTS]; // Current gain of Gain and Limiter slots
+};
+
+
+// Implementations
+
+inline real InsertChain::getBudget() const noexcept
+{
+	return staged.budget;
+}
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_SINGULAR_INSERTCHAIN_HPP__
@@ -0,0 +1,111 @@
+#include "Scrubber.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../math/fourier.hpp"
+
+namespace pg
+{
+
+constexpr std::size_t Scrubber::GRAIN_SIZE;
+constexpr std::size_t Scrubber::HOP;
+constexpr unsigned Scrubber::DEVICE_SAMPLES;
+constexpr real Scrubber::VELOCITY_MAX;
+
+/**
+ * @brief Linear interpolation of the source. Everything outside of the source
+ *  is silent.
+ */
+static real sampleAt(real const* const channel, std::size_t nSamples,
+                     real position) noexcept;
+
+
+// Implementations
+
+static inline real sampleAt(real const* const channel, std::size_t nSamples,
+                            real position) noexcept
+{
+	if (!(position >= 0.0) || position >= nSamples - 1) return 0.0;
+	std::size_t const k = (std::size_t) position;
+	real const t = position - k;
+	return channel[k] + t * (channel[k + 1] - channel[k]);
+}
+
+Scrubber::Scrubber(std::size_t nChannels, std::size_t sampleRate):
+	nChannels(nChannels), extrapolationLimit(sampleRate / 20),
+	target(0.0), velocity(0.0), generation(0), position(0.0),
+	window(GRAIN_SIZE), generationSeen(0), anchor(0.0), anchorVelocity(0.0),
+	elapsed(0), untilGrain(0)
+{
+	windowHann(window.data(), GRAIN_SIZE);
+	for (auto& grain: grains)
+		grain.age = GRAIN_SIZE;
+}
+
+std::size_t Scrubber::render(real* const* const block, std::size_t length,
+                             real const* const* const source,
+                             std::size_t nSamples) noexcept
+{
+	for (std::size_t c = 0; c < nChannels; ++c)
+		std::fill(block[c], block[c] + length, 0.0);
+
+	std::size_t i = 0;
+	while (i < length)
+	{
+		if (!untilGrain)
+		{
+			startGrain();
+			untilGrain = HOP;
+		}
+		std::size_t const n = std::min(length - i, untilGrain);
+		for (auto& grain: grains)
+		{
+			if (grain.age == GRAIN_SIZE) continue;
+			std::size_t const m = std::min(n, GRAIN_SIZE - grain.age);
+			for (std::size_t c = 0; c < nChannels; ++c)
+			{
+				real* const out = block[c] + i;
+				for (std::size_t j = 0; j < m; ++j)
+				{
+					std::size_t const k = grain.age + j;
+					out[j] += grain.gain * window[k] *
+					          sampleAt(source[c], nSamples, grain.start + k * grain.step);
+				}
+			}
+			grain.age += m;
+		}
+		i += n;
+		untilGrain -= n;
+		elapsed += n;
+	}
+	return 0;
+}
+
+void Scrubber::startGrain() noexcept
+{
+	unsigned const g = generation.load(std::memory_order_acquire);
+	if (g != generationSeen)
+	{
+		generationSeen = g;
+		anchor = target.load(std::memory_order_relaxed);
+		anchorVelocity = velocity.load(std::memory_order_relaxed);
+		elapsed = 0;
+	}
+	real const v = elapsed < extrapolationLimit ?
+	               std::max(-VELOCITY_MAX, std::min(anchorVelocity, VELOCITY_MAX)) :
+	               0.0;
+	real const p = anchor + anchorVelocity *
+	               std::min(elapsed, extrapolationLimit);
+	position.store(p, std::memory_order_relaxed);
+
+	// The grain which has finished is reused
+	Grain& grain = grains[0].age == GRAIN_SIZE ? grains[0] : grains[1];
+	// Slow drags fade in rather than being cut off
+	grain.gain = std::min(std::abs(v) * 8, 1.0);
+	grain.step = v;
+	grain.start = p;
+	grain.age = grain.gain > 0.0 ? 0 : GRAIN_SIZE;
+}
+
+} // namespace pg
@@ -0,0 +1,119 @@
+#ifndef _POLYGAMMA_SINGULAR_SCRUBBER_HPP__
+#define _POLYGAMMA_SINGULAR_SCRUBBER_HPP__
+
+#include <atomic>
+#include <vector>
+
+#include "../core/polygamma.hpp"
+
+namespace pg
+{
+
+/**
+ * The GUI thread reports the position under the mouse and its velocity
+ * whenever the mouse moves. The audio thread starts a short Hann windowed
+ * grain every HOP samples at the reported position, extrapolated by the
+ * velocity since the report, and plays it at the velocity, so the pitch
+ * follows the speed of the drag. Consecutive grains overlap by half and sum
+ * to unity. A still mouse is silent.
+ *
+ * A report is heard after at most HOP samples plus the device buffer of
+ * DEVICE_SAMPLES samples, i.e. about 12 ms at 44100 Hz.
+ *
+ * @brief Granular scrubbing of a BufferSingular.
+ */
+class Scrubber final
+{
+public:
+	static constexpr std::size_t GRAIN_SIZE = 512;
+	static constexpr std::size_t HOP = GRAIN_SIZE / 2;
+	/**
+	 * Samples per channel in the device buffer while scrubbing.
+	 */
+	static constexpr unsigned DEVICE_SAMPLES = 256;
+	/**
+	 * Fastest playback allowed, in source samples per output sample.
+	 */
+	static constexpr real VELOCITY_MAX = 4.0;
+
+	Scrubber(std::size_t nChannels, std::size_t sampleRate);
+
+	Scrubber(Scrubber const&) = delete;
+	Scrubber& operator=(Scrubber const&) = delete;
+
+	/**
+	 * Lock-free. May be called from any one thread.
+	 * @param position Source sample under the mouse.
+	 * @param velocity Source samples per output sample. Negative values play
+	 *  backwards.
+	 */
+	void scrub(real position, real velocity) noexcept;
+	/**
+	 * Lock-free.
+	 * @brief The source position of the grain started last.
+	 */
+	real getPosition() const noexcept;
+
+	/**
+	 * @warning Must only be called from one thread (the audio thread).
+	 * @brief Renders length samples of every channel from the grains.
+	 * @return 0, since the cursor does not move while scrubbing.
+	 */
+	std::size_t render(real* const* const block, std::size_t length,
+	                   real const* const* const source,
+	                   std::size_t nSamples) noexcept;
+
+private:
+	struct Grain
+	{
+		real start;
+		real step;
+		real gain;
+		std::size_t age; // GRAIN_SIZE when inactive
+	};
+
+	/**
+	 * @brief Starts a grain at the extrapolated position.
+	 */
+	void startGrain() noexcept;
+
+	std::size_t const nChannels;
+	/**
+	 * Reports older than this are no longer extrapolated, so the sound stops
+	 * shortly after the mouse does.
+	 */
+	std::size_t const extrapolationLimit;
+
+	// Shared
+	std::atomic<real> target;
+	std::atomic<real> velocity;
+	std::atomic<unsigned> generation;
+	std::atomic<real> position;
+
+	// Audio thread side
+	std::vector<real> window;
+	Grain grains[2];
+	unsigned generationSeen;
+	real anchor;
+	real anchorVelocity;
+	std::size_t elapsed; // Output samples since the report was seen
+	std::size_t untilGrain; // Output samples until the next grain starts
+};
+
+
+// Implementations
+
+inline void Scrubber::scrub(real p, real v) noexcept
+{
+	target.store(p, std::memory_order_relaxed);
+	velocity.store(v, std::memory_order_relaxed);
+	generation.fetch_add(1, std::memory_order_release);
+}
+inline real Scrubber::getPosition() const noexcept
+{
+	return position.load(std::memory_order_relaxed);
+}
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_SINGULAR_SCRUBBER_HPP__
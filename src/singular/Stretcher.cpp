@@ -0,0 +1,212 @@
+#include "Stretcher.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "../math/fourier.hpp"
+
+namespace pg
+{
+
+constexpr std::size_t Stretcher::FRAME_SIZE;
+constexpr std::size_t Stretcher::HOP;
+constexpr real Stretcher::RATE_MIN;
+constexpr real Stretcher::RATE_MAX;
+
+/**
+ * @brief sourceAt Reads a sample, treating everything outside of the source
+ *  as silence.
+ */
+real sourceAt(real const* const channel, std::size_t nSamples,
+              std::ptrdiff_t index) noexcept;
+
+
+// Implementations
+
+inline real sourceAt(real const* const channel, std::size_t nSamples,
+                     std::ptrdiff_t index) noexcept
+{
+	return index >= 0 && (std::size_t) index < nSamples ? channel[index] : 0.0;
+}
+
+Stretcher::Stretcher(std::size_t nChannels):
+	nChannels(nChannels), mode(Normal), rate(1.0),
+	modeApplied(Normal), position(0.0), cursorExpected(0),
+	planForward(FFTPlan<real>::get(FRAME_SIZE, FFTPlan<real>::Forward)),
+	planInverse(FFTPlan<real>::get(FRAME_SIZE, FFTPlan<real>::Inverse)),
+	window(FRAME_SIZE), frame(FRAME_SIZE),
+	spectrum(FRAME_SIZE / 2 + 1), synthesis(FRAME_SIZE / 2 + 1),
+	phaseAnalysis((FRAME_SIZE / 2 + 1) * nChannels),
+	phaseSynthesis((FRAME_SIZE / 2 + 1) * nChannels),
+	accumulator(FRAME_SIZE * nChannels),
+	output(HOP * nChannels),
+	scratch(std::max(planForward.getScratchSize(),
+	                 planInverse.getScratchSize())),
+	centrePrevious(0), primed(false), outputAvailable(0), outputRead(0)
+{
+	windowHann(window.data(), FRAME_SIZE);
+}
+
+void Stretcher::setRate(real r) throw(PythonException)
+{
+	if (!(r >= RATE_MIN && r <= RATE_MAX))
+		throw PythonException{"Rate out of range", PythonException::ValueError};
+	rate.store(r, std::memory_order_relaxed);
+}
+
+std::size_t Stretcher::render(real* const* const block, std::size_t length,
+                              real const* const* const source,
+                              std::size_t nSamples, std::size_t cursor,
+                              std::size_t* const consumed) noexcept
+{
+	Mode const m = mode.load(std::memory_order_relaxed);
+	real const r = rate.load(std::memory_order_relaxed);
+	// Mode changes and seeks both discard the state
+	if (m != modeApplied || cursor != cursorExpected)
+		reset(m, cursor);
+
+	// Every output sample advances the source position by the rate
+	real const step = m == Normal ? 1.0 : r;
+	std::size_t const valid = position < nSamples ?
+	                          (std::size_t) std::min<real>(
+	                            length, std::ceil((nSamples - position) / step)) :
+	                          0;
+
+	switch (m)
+	{
+	case Varispeed:
+		renderVarispeed(block, length, source, nSamples, r);
+		break;
+	case TimeStretch:
+		renderTimeStretch(block, length, source, nSamples, r);
+		break;
+	default:
+		for (std::size_t c = 0; c < nChannels; ++c)
+			for (std::size_t i = 0; i < length; ++i)
+				block[c][i] = sourceAt(source[c], nSamples, cursor + i);
+		position += length;
+		break;
+	}
+
+	// The cursor stops at the end of the source
+	std::size_t const end = std::min<real>(position, nSamples);
+	*consumed = end > cursor ? end - cursor : 0;
+	cursorExpected = cursor + *consumed;
+	return valid;
+}
+
+void Stretcher::reset(Mode m, std::size_t cursor) noexcept
+{
+	modeApplied = m;
+	position = cursor;
+	cursorExpected = cursor;
+	primed = false;
+	outputAvailable = outputRead = 0;
+	std::fill(accumulator.begin(), accumulator.end(), 0.0);
+}
+
+void Stretcher::renderVarispeed(real* const* const block, std::size_t length,
+                                real const* const* const source,
+                                std::size_t nSamples, real r) noexcept
+{
+	// Catmull-Rom interpolation between the source samples
+	for (std::size_t c = 0; c < nChannels; ++c)
+	{
+		real const* const x = source[c];
+		for (std::size_t i = 0; i < length; ++i)
+		{
+			real const p = position + i * r;
+			std::ptrdiff_t const k = (std::ptrdiff_t) std::floor(p);
+			real const t = p - k;
+			real const xm = sourceAt(x, nSamples, k - 1);
+			real const x0 = sourceAt(x, nSamples, k);
+			real const x1 = sourceAt(x, nSamples, k + 1);
+			real const x2 = sourceAt(x, nSamples, k + 2);
+			block[c][i] = x0 + 0.5 * t * (x1 - xm + t * (2 * xm - 5 * x0 + 4 * x1 - x2
+			                              + t * (3 * (x0 - x1) + x2 - xm)));
+		}
+	}
+	position += length * r;
+}
+
+void Stretcher::renderTimeStretch(real* const* const block, std::size_t length,
+                                  real const* const* const source,
+                                  std::size_t nSamples, real r) noexcept
+{
+	std::size_t produced = 0;
+	while (produced < length)
+	{
+		if (outputRead == outputAvailable)
+			synthesise(source, nSamples, r);
+		std::size_t const n = std::min(length - produced,
+		                               outputAvailable - outputRead);
+		for (std::size_t c = 0; c < nChannels; ++c)
+			std::memcpy(block[c] + produced, &output[c * HOP + outputRead],
+			            n * sizeof(real));
+		outputRead += n;
+		produced += n;
+		position += n * r;
+	}
+}
+
+void Stretcher::synthesise(real const* const* const source,
+                           std::size_t nSamples, real r) noexcept
+{
+	std::size_t const nBins = FRAME_SIZE / 2 + 1;
+	// Hann analysis and synthesis windows at a hop of a quarter frame
+	real const gain = 1.0 / 1.5;
+
+	/*
+	 * The accumulator begins at the next output sample, whose source position
+	 * is position. Hence the frame centre lies half a frame of output later.
+	 */
+	std::ptrdiff_t const centre =
+	  (std::ptrdiff_t) std::lround(position + FRAME_SIZE / 2 * r);
+	real const hopAnalysis = centre - centrePrevious;
+
+	for (std::size_t c = 0; c < nChannels; ++c)
+	{
+		real const* const x = source[c];
+		for (std::size_t k = 0; k < FRAME_SIZE; ++k)
+			frame[k] = window[k] *
+			           sourceAt(x, nSamples, centre - (std::ptrdiff_t) FRAME_SIZE / 2 + k);
+		planForward.executeReal(spectrum.data(), frame.data(), scratch.data());
+
+		real* const phaseA = &phaseAnalysis[c * nBins];
+		real* const phaseS = &phaseSynthesis[c * nBins];
+		for (std::size_t k = 0; k < nBins; ++k)
+		{
+			real const magnitude = std::abs(spectrum[k]);
+			real const phase = std::arg(spectrum[k]);
+			if (primed && hopAnalysis > 0.0)
+			{
+				// Deviation from the bin frequency gives the true frequency
+				real const omega = 2 * M_PI * k / FRAME_SIZE;
+				real delta = phase - phaseA[k] - omega * hopAnalysis;
+				delta -= 2 * M_PI * std::round(delta / (2 * M_PI));
+				phaseS[k] += (omega + delta / hopAnalysis) * HOP;
+			}
+			else
+				phaseS[k] = phase;
+			phaseA[k] = phase;
+			synthesis[k] = std::polar(magnitude, phaseS[k]);
+		}
+		planInverse.executeReal(frame.data(), synthesis.data(), 1.0 / FRAME_SIZE,
+		                        scratch.data());
+
+		// Overlap-add, then take the completed hop
+		real* const acc = &accumulator[c * FRAME_SIZE];
+		for (std::size_t k = 0; k < FRAME_SIZE; ++k)
+			acc[k] += frame[k] * window[k] * gain;
+		std::memcpy(&output[c * HOP], acc, HOP * sizeof(real));
+		std::memmove(acc, acc + HOP, (FRAME_SIZE - HOP) * sizeof(real));
+		std::fill(acc + FRAME_SIZE - HOP, acc + FRAME_SIZE, 0.0);
+	}
+	centrePrevious = centre;
+	primed = true;
+	outputAvailable = HOP;
+	outputRead = 0;
+}
+
+} // namespace pg
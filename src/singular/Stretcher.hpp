@@ -0,0 +1,145 @@
+#ifndef _POLYGAMMA_SINGULAR_STRETCHER_HPP__
+#define _POLYGAMMA_SINGULAR_STRETCHER_HPP__
+
+#include <atomic>
+#include <vector>
+
+#include "../core/polygamma.hpp"
+#include "../core/python.hpp"
+#include "../math/FFTPlan.hpp"
+
+namespace pg
+{
+
+/**
+ * Varispeed resamples the source, so the pitch follows the rate. TimeStretch
+ * runs a streaming phase vocoder which preserves the pitch. Both read the
+ * source directly around the playback position and never look further ahead
+ * than FRAME_SIZE samples, so their memory does not depend on the length of
+ * the buffer.
+ *
+ * The mode and rate are set by the Kernel thread and picked up lock-free by
+ * the audio thread at the next block.
+ *
+ * @brief Realtime change of playback speed of a BufferSingular.
+ */
+class Stretcher final
+{
+public:
+	enum Mode
+	{
+		Normal,
+		Varispeed,
+		TimeStretch
+	};
+	/**
+	 * Length of the phase vocoder analysis frame. Must be a power of 2.
+	 */
+	static constexpr std::size_t FRAME_SIZE = 2048;
+	static constexpr std::size_t HOP = FRAME_SIZE / 4;
+	static constexpr real RATE_MIN = 0.25;
+	static constexpr real RATE_MAX = 4.0;
+
+	Stretcher(std::size_t nChannels);
+
+	Stretcher(Stretcher const&) = delete;
+	Stretcher& operator=(Stretcher const&) = delete;
+
+	/**
+	 * Exposed to Python
+	 */
+	Mode getMode() const noexcept;
+	void setMode(Mode) noexcept;
+	/**
+	 * Exposed to Python
+	 * @brief Ratio of source samples consumed to samples played. 1.5 plays
+	 *  1.5 times as fast.
+	 */
+	real getRate() const noexcept;
+	void setRate(real) throw(PythonException);
+
+	/**
+	 * @warning Must only be called from one thread (the audio thread).
+	 * @brief Renders length samples of every channel, starting from cursor.
+	 *  Samples outside of the source are silent.
+	 * @param[out] block Planar output
+	 * @param[in] source Planar source of nSamples samples per channel
+	 * @param[out] consumed The number of source samples by which the cursor
+	 *  advances, up to the end of the source.
+	 * @return The number of samples played from before the end of the
+	 *  source. The rest of block is padding.
+	 */
+	std::size_t render(real* const* const block, std::size_t length,
+	                   real const* const* const source, std::size_t nSamples,
+	                   std::size_t cursor, std::size_t* const consumed) noexcept;
+
+private:
+	/**
+	 * @brief Restarts from cursor, forgetting all previous state.
+	 */
+	void reset(Mode, std::size_t cursor) noexcept;
+	void renderVarispeed(real* const* const block, std::size_t length,
+	                     real const* const* const source, std::size_t nSamples,
+	                     real rate) noexcept;
+	void renderTimeStretch(real* const* const block, std::size_t length,
+	                       real const* const* const source, std::size_t nSamples,
+	                       real rate) noexcept;
+	/**
+	 * @brief Synthesises one phase vocoder frame, making HOP new samples
+	 *  available in output.
+	 */
+	void synthesise(real const* const* const source, std::size_t nSamples,
+	                real rate) noexcept;
+
+	std::size_t const nChannels;
+
+	std::atomic<Mode> mode;
+	std::atomic<real> rate;
+
+	// Audio thread side
+	Mode modeApplied;
+	/*
+	 * Source position of the next output sample. Kept fractional since the
+	 * cursor only advances by whole samples.
+	 */
+	real position;
+	std::size_t cursorExpected;
+
+	// Phase vocoder. The plans and their scratch are obtained upfront to keep
+	// the cache lock and allocations off the audio thread.
+	FFTPlan<real> const& planForward;
+	FFTPlan<real> const& planInverse;
+	std::vector<real> window;
+	std::vector<real> frame;
+	std::vector<complex> spectrum; // FRAME_SIZE / 2 + 1
+	std::vector<complex> synthesis; // FRAME_SIZE / 2 + 1
+	std::vector<real> phaseAnalysis; // (FRAME_SIZE / 2 + 1) per channel
+	std::vector<real> phaseSynthesis; // (FRAME_SIZE / 2 + 1) per channel
+	std::vector<real> accumulator; // FRAME_SIZE per channel
+	std::vector<real> output; // HOP per channel
+	std::vector<complex> scratch; // Of both plans
+	std::ptrdiff_t centrePrevious;
+	bool primed;
+	std::size_t outputAvailable; // Samples of accumulator ready to be played
+	std::size_t outputRead;
+};
+
+
+// Implementations
+
+inline Stretcher::Mode Stretcher::getMode() const noexcept
+{
+	return mode.load(std::memory_order_relaxed);
+}
+inline void Stretcher::setMode(Mode m) noexcept
+{
+	mode.store(m, std::memory_order_relaxed);
+}
+inline real Stretcher::getRate() const noexcept
+{
+	return rate.load(std::memory_order_relaxed);
+}
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_SINGULAR_STRETCHER_HPP__
@@ -1,12 +1,289 @@
 #include "audio.hpp"
 
+#include <cmath>
+#include <functional>
 #include <iostream>
+#include <map>
+
+#include "selection.hpp"
+#include "../math/BiquadBank.hpp"
+#include "../math/arithmetic.hpp"
+#include "../math/curve.hpp"
+#include "../math/parallel.hpp"
 
 namespace pg
 {
 
+/**
+ * @brief Parses the name of a curve, throwing ValueError if it is unknown.
+ */
+CurveType curveOf(std::string const& name) throw(PythonException);
+/**
+ * The curve spans the whole selection of the chunk and is traversed backwards
+ * if reverse is set. If source is not nullptr, source multiplied by the curve
+ * traversed in the other direction is added, which crossfades the chunk into
+ * the source.
+ * @brief Multiplies data, the samples of chunk, by a curve.
+ */
+void fadeChunk(real* const data, real const* const source,
+               selectionChunk const& chunk, CurveType,
+               bool reverse) noexcept;
+/**
+ * @brief Weight of channel i of the buffer in the loudness sum, according to
+ *  its channel layout.
+ */
+real loudnessWeight(BufferSingular const*, std::size_t i) noexcept;
+/**
+ * @brief Channels which have a selection, from the beginning of the union of
+ *  the selections, which is written to range. Throws ValueError if it is
+ *  empty.
+ */
+std::vector<real const*> selectedChannels(BufferSingular*,
+                                          IntervalIndex* const range)
+throw(PythonException);
+/**
+ * @brief Runs the selection of the buffer through Dynamics of the given
+ *  parameters, see compress.
+ */
+void applyDynamics(BufferSingular*, dynamics const&) throw(PythonException);
+
+/**
+ * Longest lookahead of compress and limit in seconds.
+ */
+constexpr real MAX_LOOKAHEAD = 0.1;
+/**
+ * Most frames averaged on either side by denoise.
+ */
+constexpr std::size_t MAX_SMOOTH_FRAMES = 32;
+
+
+// Implementations
+
+CurveType curveOf(std::string const& name) throw(PythonException)
+{
+	CurveType type;
+	if (!curveParse(&type, name))
+		throw PythonException{"Unknown curve: " + name,
+		                      PythonException::ValueError};
+	return type;
+}
+void fadeChunk(real* const data, real const* const source,
+               selectionChunk const& chunk, CurveType type,
+               bool reverse) noexcept
+{
+	// From 0 on the first sample of the selection to 1 on the last
+	real const dt = 1.0 / std::max<std::size_t>(chunk.total - 1, 1);
+	real const t0 = chunk.offset * dt;
+	if (type == CurveLinear && !source)
+	{
+		arrayRamp(data, chunk.length, reverse ? 1.0 - t0 : t0,
+		          reverse ? -dt : dt);
+		return;
+	}
+
+	// The gains of a block stay in L1 between rendering and applying them
+	constexpr std::size_t BLOCK = 1024;
+	real gains[BLOCK];
+	for (std::size_t i = 0; i < chunk.length; i += BLOCK)
+	{
+		std::size_t const n = std::min(BLOCK, chunk.length - i);
+		real const t = t0 + i * dt;
+		curveRender(gains, n, type, reverse ? 1.0 - t : t, reverse ? -dt : dt);
+		arrayMultiply(data + i, gains, n);
+		if (source)
+		{
+			curveRender(gains, n, type, reverse ? t : 1.0 - t, reverse ? dt : -dt);
+			arrayMultiplyAdd(data + i, source + i, gains, n);
+		}
+	}
+}
+
+real loudnessWeight(BufferSingular const* buffer, std::size_t i) noexcept
+{
+	// BS.1770 weighs the surround channels more and omits the LFE
+	uint64_t const channel =
+	  av_channel_layout_extract_channel(buffer->getChannelLayout(), i);
+	if (channel == AV_CH_LOW_FREQUENCY)
+		return 0.0;
+	if (channel & (AV_CH_SIDE_LEFT | AV_CH_SIDE_RIGHT |
+	               AV_CH_BACK_LEFT | AV_CH_BACK_RIGHT))
+		return 1.41;
+	return 1.0;
+}
+std::vector<real const*> selectedChannels(BufferSingular* buffer,
+                                          IntervalIndex* const range)
+throw(PythonException)
+{
+	*range = INTERVALINDEX_NULL;
+	for (std::size_t i = 0; i < buffer->nAudioChannels(); ++i)
+	{
+		IntervalIndex const selection = buffer->getSelection(i);
+		if (!isEmpty(selection))
+			*range += selection;
+	}
+	if (isEmpty(*range))
+		throw PythonException{"The selection is empty",
+		                      PythonException::ValueError};
+	std::vector<real const*> channels;
+	for (std::size_t i = 0; i < buffer->nAudioChannels(); ++i)
+		if (!isEmpty(buffer->getSelection(i)))
+			channels.push_back(buffer->audioChannel(i)->getData() + range->begin);
+	return channels;
+}
+
 void silence(BufferSingular* buffer)
 {
+	processSelection(buffer, [](selectionChunk const& chunk)
+	{
+		std::fill(chunk.data, chunk.data + chunk.length, 0.0);
+	});
+}
+void gain(BufferSingular* buffer, real gainDB)
+{
+	real const g = std::pow(10.0, gainDB / 20);
+	processSelection(buffer, [g](selectionChunk const& chunk)
+	{
+		arrayScale(chunk.data, chunk.length, g);
+	});
+}
+void invert(BufferSingular* buffer)
+{
+	processSelection(buffer, [](selectionChunk const& chunk)
+	{
+		arrayScale(chunk.data, chunk.length, -1.0);
+	});
+}
+void removeDC(BufferSingular* buffer)
+{
+	std::vector<real> const sums = reduceSelection(buffer, 0.0,
+	                               [](selectionChunk const& chunk)
+	{
+		return arraySum(chunk.data, chunk.length);
+	}, std::plus<real>());
+	processSelection(buffer, [&sums](selectionChunk const& chunk)
+	{
+		arrayAdd(chunk.data, chunk.length, -sums[chunk.channel] / chunk.total);
+	});
+}
+void fadeIn(BufferSingular* buffer, std::string shape) throw(PythonException)
+{
+	CurveType const type = curveOf(shape);
+	processSelection(buffer, [type](selectionChunk const& chunk)
+	{
+		fadeChunk(chunk.data, nullptr, chunk, type, false);
+	});
+}
+void fadeOut(BufferSingular* buffer, std::string shape) throw(PythonException)
+{
+	CurveType const type = curveOf(shape);
+	processSelection(buffer, [type](selectionChunk const& chunk)
+	{
+		fadeChunk(chunk.data, nullptr, chunk, type, true);
+	});
+}
+void applyEnvelope(BufferSingular* buffer, Envelope const& envelope)
+{
+	processSelection(buffer, [&envelope](selectionChunk const& chunk)
+	{
+		constexpr std::size_t BLOCK = 1024;
+		real gains[BLOCK];
+		for (std::size_t i = 0; i < chunk.length; i += BLOCK)
+		{
+			std::size_t const n = std::min(BLOCK, chunk.length - i);
+			envelope.render(gains, chunk.index + i, n);
+			arrayMultiply(chunk.data + i, gains, n);
+		}
+	});
+}
+void crossfade(BufferSingular* buffer, BufferSingular const* source,
+               std::size_t offset, std::string shape) throw(PythonException)
+{
+	CurveType const type = curveOf(shape);
+	if (source->nAudioChannels() != buffer->nAudioChannels())
+		throw PythonException{"The number of channels differs",
+		                      PythonException::ValueError};
+	for (std::size_t i = 0; i < buffer->nAudioChannels(); ++i)
+	{
+		IntervalIndex const selection = buffer->getSelection(i);
+		if (isEmpty(selection))
+			continue;
+		if (offset + selection.end - selection.begin > source->duration())
+			throw PythonException{"Source out of range",
+			                      PythonException::IndexError};
+		// The chunks would otherwise read samples which other chunks write
+		if (source == buffer && offset < selection.end &&
+		    selection.begin < offset + selection.end - selection.begin)
+			throw PythonException{"The source overlaps the selection",
+			                      PythonException::ValueError};
+	}
+
+	processSelection(buffer, [source, offset, type](selectionChunk const& chunk)
+	{
+		fadeChunk(chunk.data, source->audioChannel(chunk.channel)->getData() +
+		          offset + chunk.offset, chunk, type, true);
+	});
+}
+void normalize(BufferSingular* buffer, real targetDB, std::string mode)
+throw(PythonException)
+{
+	IntervalIndex range;
+	selectionChunks(buffer, &range);
+	if (isEmpty(range))
+		return;
+
+	real level;
+	if (mode == "peak")
+	{
+		std::vector<real> const peaks = reduceSelection(buffer, 0.0,
+		                                [](selectionChunk const& chunk)
+		{
+			return arrayPeak(chunk.data, chunk.length);
+		}, [](real a, real b) { return std::max(a, b); });
+		level = 20 * std::log10(*std::max_element(peaks.begin(), peaks.end()));
+	}
+	else if (mode == "loudness")
+	{
+		// Only the channels which are changed are measured
+		std::vector<real> weights;
+		std::vector<real const*> const channels = selectedChannels(buffer, &range);
+		for (std::size_t i = 0; i < buffer->nAudioChannels(); ++i)
+			if (!isEmpty(buffer->getSelection(i)))
+				weights.push_back(loudnessWeight(buffer, i));
+		level = analyze(channels.data(), channels.size(), range.end - range.begin,
+		                buffer->timeBase(), weights.data()).integrated;
+	}
+	else
+		throw PythonException{"Unknown mode: " + mode, PythonException::ValueError};
+
+	if (std::isinf(level))
+		throw PythonException{"The selection is silent",
+		                      PythonException::ValueError};
+	gain(buffer, targetDB - level);
+}
+
+void filter(BufferSingular* buffer, std::string shape, real frequency, real q,
+            real gainDB, std::size_t order) throw(PythonException)
+{
+	real const sampleRate = buffer->timeBase();
+	if (!(frequency > 0.0 && frequency < sampleRate * 0.5))
+		throw PythonException{"Frequency must lie between 0 and the Nyquist frequency",
+		                      PythonException::ValueError};
+	if (!(q > 0.0))
+		throw PythonException{"Q must be positive", PythonException::ValueError};
+	bool const pass = shape == "lowpass" || shape == "highpass";
+	if (pass ? order < 2 || order % 2 || order > 48 : order != 2)
+		throw PythonException{"Invalid order", PythonException::ValueError};
+
+	std::vector<biquad> sections(1);
+	if (!biquadShape(&sections[0], shape, frequency, q, gainDB, sampleRate))
+		throw PythonException{"Unknown filter shape: " + shape,
+		                      PythonException::ValueError};
+	if (order > 2)
+		sections = biquadButterworth(shape == "highpass", frequency, order,
+		                             sampleRate);
+
+	// Channels with the same selection are filtered together
+	std::map<std::pair<std::size_t, std::size_t>, std::vector<real*>> groups;
 	IntervalIndex changed(std::numeric_limits<std::size_t>::max(), 0);
 	for (std::size_t i = 0; i < buffer->nAudioChannels(); ++i)
 	{
@@ -14,15 +291,224 @@ void silence(BufferSingular* buffer)
 		if (!isEmpty(selection))
 		{
 			changed += selection;
-			Vector<pg::real>* const channel = buffer->audioChannel(i);
-			for (std::size_t j = selection.begin; j < selection.end; ++j)
-			{
-				(*channel)[j] = 0.0;
-			}
+			groups[std::make_pair(selection.begin, selection.end)].push_back(
+			  buffer->audioChannel(i)->getData() + selection.begin);
 		}
 	}
+	for (auto const& group: groups)
+	{
+		std::size_t const length = group.first.second - group.first.first;
+		std::vector<real*> const& channels = group.second;
+		std::size_t const nPairs = (channels.size() + 1) / 2;
+		parallelRanges(0, nPairs, threadCount(0, nPairs, 1),
+		               [&](std::size_t first, std::size_t last)
+		{
+			std::size_t const end = std::min(2 * last, channels.size());
+			BiquadBank bank(end - 2 * first, sections);
+			bank.process(channels.data() + 2 * first, length);
+		});
+	}
+	if (!isEmpty(changed))
+		buffer->notifyUpdate(Buffer::Update::Data, changed);
+}
+
+void applyDynamics(BufferSingular* buffer, dynamics const& d)
+throw(PythonException)
+{
+	if (!(d.ratio >= 1.0))
+		throw PythonException{"Ratio must be at least 1",
+		                      PythonException::ValueError};
+	if (!(d.attack >= 0.0 && d.release >= 0.0))
+		throw PythonException{"Time constants must be positive",
+		                      PythonException::ValueError};
+	if (!(d.lookahead >= 0.0 && d.lookahead <= MAX_LOOKAHEAD))
+		throw PythonException{"Lookahead out of range",
+		                      PythonException::ValueError};
+	if (!(d.knee >= 0.0) || !std::isfinite(d.threshold) ||
+	    !std::isfinite(d.makeup))
+		throw PythonException{"Invalid level", PythonException::ValueError};
+
+	// Channels with the same selection are linked
+	std::map<std::pair<std::size_t, std::size_t>, std::vector<real*>> groups;
+	IntervalIndex changed(std::numeric_limits<std::size_t>::max(), 0);
+	for (std::size_t i = 0; i < buffer->nAudioChannels(); ++i)
+	{
+		auto selection = buffer->getSelection(i);
+		if (!isEmpty(selection))
+		{
+			changed += selection;
+			groups[std::make_pair(selection.begin, selection.end)].push_back(
+			  buffer->audioChannel(i)->getData() + selection.begin);
+		}
+	}
+	std::vector<std::pair<std::size_t, std::vector<real*>>> jobs;
+	for (auto const& group: groups)
+		jobs.emplace_back(group.first.second - group.first.first, group.second);
+	real const sampleRate = buffer->timeBase();
+	ThreadPool::get().run(jobs.size(), [&](std::size_t i)
+	{
+		Dynamics dynamics(jobs[i].second.size(), d, sampleRate);
+		dynamics.processAligned(jobs[i].second.data(), jobs[i].first);
+	});
+	if (!isEmpty(changed))
+		buffer->notifyUpdate(Buffer::Update::Data, changed);
+}
+void compress(BufferSingular* buffer, real thresholdDB, real ratio,
+              real attack, real release, real kneeDB, real lookahead,
+              real makeupDB, std::string detector) throw(PythonException)
+{
+	if (detector != "peak" && detector != "rms")
+		throw PythonException{"Unknown detector: " + detector,
+		                      PythonException::ValueError};
+	applyDynamics(buffer, dynamics{thresholdDB, ratio, kneeDB, attack, release,
+	                               lookahead, makeupDB, detector == "rms"});
+}
+void limit(BufferSingular* buffer, real ceilingDB, real release,
+           real lookahead) throw(PythonException)
+{
+	if (!(lookahead > 0.0))
+		throw PythonException{"The lookahead of a limiter must be positive",
+		                      PythonException::ValueError};
+	real const ratio = std::numeric_limits<real>::infinity();
+	applyDynamics(buffer, dynamics{ceilingDB, ratio, 0.0, 0.0, release,
+	                               lookahead, 0.0, false});
+}
+
+Analysis analyze(BufferSingular* buffer, IntervalIndex selection)
+throw(PythonException)
+{
+	if (selection.begin > selection.end || selection.end > buffer->duration())
+		throw PythonException{"Selection out of range",
+		                      PythonException::IndexError};
+
+	std::vector<real const*> channels;
+	std::vector<real> weights;
+	for (std::size_t i = 0; i < buffer->nAudioChannels(); ++i)
+	{
+		channels.push_back(buffer->audioChannel(i)->getData() + selection.begin);
+		weights.push_back(loudnessWeight(buffer, i));
+	}
+	return analyze(channels.data(), channels.size(),
+	               selection.end - selection.begin, buffer->timeBase(),
+	               weights.data());
+}
+
+Alignment align(BufferSingular const* a, BufferSingular const* b,
+                std::size_t maxLag) throw(PythonException)
+{
+	if (a->timeBase() != b->timeBase())
+		throw PythonException{"The sample rates differ",
+		                      PythonException::ValueError};
+	std::vector<real const*> channelsA, channelsB;
+	for (std::size_t i = 0; i < a->nAudioChannels(); ++i)
+		channelsA.push_back(a->audioChannel(i)->getData());
+	for (std::size_t i = 0; i < b->nAudioChannels(); ++i)
+		channelsB.push_back(b->audioChannel(i)->getData());
+	return align(channelsA.data(), channelsA.size(), a->duration(),
+	             channelsB.data(), channelsB.size(), b->duration(), maxLag);
+}
+
+NoiseProfile noiseProfile(BufferSingular* buffer) throw(PythonException)
+{
+	std::vector<real const*> signals;
+	std::vector<std::size_t> lengths;
+	for (std::size_t i = 0; i < buffer->nAudioChannels(); ++i)
+	{
+		IntervalIndex const selection = buffer->getSelection(i);
+		if (isEmpty(selection))
+			continue;
+		signals.push_back(buffer->audioChannel(i)->getData() + selection.begin);
+		lengths.push_back(selection.end - selection.begin);
+	}
+	NoiseProfile const profile = noiseProfile(signals.data(), lengths.data(),
+	                                          signals.size(), buffer->timeBase());
+	if (!profile.nFrames)
+		throw PythonException{"The selection is empty",
+		                      PythonException::ValueError};
+	return profile;
+}
+void denoise(BufferSingular* buffer, NoiseProfile const& profile,
+             real thresholdDB, real reductionDB, std::size_t smoothBins,
+             std::size_t smoothFrames) throw(PythonException)
+{
+	if (profile.sampleRate != buffer->timeBase())
+		throw PythonException{"The profile was measured at another sample rate",
+		                      PythonException::ValueError};
+	if (!std::isfinite(thresholdDB) || !(reductionDB >= 0.0))
+		throw PythonException{"Invalid level", PythonException::ValueError};
+	if (smoothFrames > MAX_SMOOTH_FRAMES ||
+	    smoothBins >= profile.magnitude.size())
+		throw PythonException{"Smoothing out of range",
+		                      PythonException::ValueError};
+
+	// The frames of every channel are transformed in parallel
+	IntervalIndex changed(std::numeric_limits<std::size_t>::max(), 0);
+	for (std::size_t i = 0; i < buffer->nAudioChannels(); ++i)
+	{
+		IntervalIndex const selection = buffer->getSelection(i);
+		if (isEmpty(selection))
+			continue;
+		changed += selection;
+		denoise(buffer->audioChannel(i)->getData() + selection.begin,
+		        selection.end - selection.begin, profile, thresholdDB,
+		        reductionDB, smoothBins, smoothFrames);
+	}
 	if (!isEmpty(changed))
 		buffer->notifyUpdate(Buffer::Update::Data, changed);
 }
 
+std::vector<IntervalIndex> detectSilence(BufferSingular* buffer,
+                                         real thresholdDB, real minDuration)
+throw(PythonException)
+{
+	if (!(minDuration >= 0.0))
+		throw PythonException{"The duration must be positive",
+		                      PythonException::ValueError};
+	IntervalIndex range;
+	std::vector<real const*> const channels = selectedChannels(buffer, &range);
+	std::vector<IntervalIndex> silences =
+	  detectSilence(channels.data(), channels.size(), range.end - range.begin,
+	                std::pow(10.0, thresholdDB / 20),
+	                std::lround(minDuration * buffer->timeBase()));
+	for (auto& s: silences)
+		s += range.begin;
+	return silences;
+}
+std::vector<IntervalIndex> detectOnsets(BufferSingular* buffer,
+                                        real threshold, real minInterval)
+throw(PythonException)
+{
+	if (!(minInterval >= 0.0))
+		throw PythonException{"The interval must be positive",
+		                      PythonException::ValueError};
+	IntervalIndex range;
+	std::vector<real const*> const channels = selectedChannels(buffer, &range);
+	real const sampleRate = buffer->timeBase();
+	std::vector<std::size_t> const onsets =
+	  detectOnsets(channels.data(), channels.size(), range.end - range.begin,
+	               sampleRate, threshold, std::lround(minInterval * sampleRate));
+	std::vector<IntervalIndex> segments;
+	for (std::size_t i = 0; i < onsets.size(); ++i)
+		segments.emplace_back(range.begin + onsets[i], i + 1 < onsets.size() ?
+		                      range.begin + onsets[i + 1] : range.end);
+	return segments;
+}
+Pitch detectPitch(BufferSingular* buffer, real minFrequency,
+                  real maxFrequency, real threshold) throw(PythonException)
+{
+	real const sampleRate = buffer->timeBase();
+	if (!(minFrequency > 0.0 && minFrequency < maxFrequency &&
+	      maxFrequency < sampleRate * 0.5))
+		throw PythonException{"Frequencies must increase between 0 and the Nyquist frequency",
+		                      PythonException::ValueError};
+	IntervalIndex range;
+	std::vector<real const*> const channels = selectedChannels(buffer, &range);
+	Pitch pitch = detectPitch(channels.data(), channels.size(),
+	                          range.end - range.begin, sampleRate, minFrequency,
+	                          maxFrequency, threshold);
+	for (auto& v: pitch.voiced)
+		v += range.begin;
+	return pitch;
+}
+
 } // namespace pg
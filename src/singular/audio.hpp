@@ -2,15 +2,187 @@
 #define _POLYGAMMA_SINGULAR_AUDIO_HPP__
 
 #include "BufferSingular.hpp"
+#include "../math/Dynamics.hpp"
+#include "../math/Envelope.hpp"
+#include "../math/analysis.hpp"
+#include "../math/correlation.hpp"
+#include "../math/denoise.hpp"
+#include "../math/detection.hpp"
 
 namespace pg
 {
 
+/*
+ * The functions below which edit the buffer process the selection of every
+ * channel in parallel chunks, see singular/selection.hpp, and notify the
+ * buffer once.
+ */
+
 /**
  * Exposed to Python
  * @brief Silences the buffer according to the selection in the buffer.
  */
 void silence(BufferSingular*);
+/**
+ * Exposed to Python
+ * @brief Amplifies the selection by gainDB decibels.
+ */
+void gain(BufferSingular*, real gainDB);
+/**
+ * Exposed to Python
+ * @brief Inverts the polarity of the selection.
+ */
+void invert(BufferSingular*);
+/**
+ * Exposed to Python
+ * @brief Subtracts the mean of the selection of every channel from it.
+ */
+void removeDC(BufferSingular*);
+/**
+ * Exposed to Python
+ * The fades of the same shape are mirror images of each other. See
+ * math/curve.hpp for the shapes.
+ * @brief Fades the selection in from silence, or out to silence.
+ * @param[in] shape "linear", "sine", "scurve" or "exponential"
+ */
+void fadeIn(BufferSingular*, std::string shape) throw(PythonException);
+void fadeOut(BufferSingular*, std::string shape) throw(PythonException);
+/**
+ * Exposed to Python
+ * The envelope is indexed by sample within the buffer, and rendered a chunk
+ * at a time.
+ * @brief Multiplies the selection by the envelope.
+ */
+void applyEnvelope(BufferSingular*, Envelope const&);
+/**
+ * Exposed to Python
+ * The selection of every channel fades out while the same channel of source,
+ * starting at offset, fades in. "sine" keeps the power constant for
+ * uncorrelated material and "linear" keeps the amplitude constant for
+ * identical material.
+ * @brief Crossfades the selection into source.
+ * @param[in] source May be the buffer itself if the regions do not overlap.
+ */
+void crossfade(BufferSingular*, BufferSingular const* source,
+               std::size_t offset, std::string shape) throw(PythonException);
+/**
+ * Exposed to Python
+ * The same gain is applied to every channel, which keeps the balance. The
+ * peak is found in a parallel pass over the selection; the loudness is the
+ * integrated loudness of the union of the selections, see analyze.
+ * @brief Amplifies the selection so that its level reaches targetDB.
+ * @param[in] mode "peak" (dBFS) or "loudness" (LUFS)
+ */
+void normalize(BufferSingular*, real targetDB, std::string mode)
+throw(PythonException);
+/**
+ * Exposed to Python
+ * Each selection starts from filters at rest. Channels are filtered in pairs
+ * on separate threads.
+ * @brief Filters the buffer in place according to the selection in the
+ *  buffer.
+ * @param[in] shape "lowpass", "highpass", "peak", "lowshelf" or "highshelf"
+ * @param[in] order Order of "lowpass" and "highpass", which must be even.
+ *  Order 2 is a single section of the given q, higher orders are Butterworth
+ *  cascades which ignore q. Must be 2 for the other shapes.
+ */
+void filter(BufferSingular*, std::string shape, real frequency, real q,
+            real gainDB, std::size_t order) throw(PythonException);
+/**
+ * Exposed to Python
+ * The channels which share a selection are compressed together with the same
+ * gain, and such groups run in parallel. Each selection starts from rest, and
+ * the lookahead is compensated so the material does not move. See
+ * math/Dynamics.hpp.
+ * @brief Compresses the selection.
+ * @param[in] thresholdDB Threshold in dBFS.
+ * @param[in] ratio At least 1.
+ * @param[in] attack, release Time constants in seconds.
+ * @param[in] kneeDB Width of the soft knee.
+ * @param[in] lookahead In seconds, at most MAX_LOOKAHEAD.
+ * @param[in] makeupDB Gain applied after the compression.
+ * @param[in] detector "peak" or "rms"
+ */
+void compress(BufferSingular*, real thresholdDB, real ratio, real attack,
+              real release, real kneeDB, real lookahead, real makeupDB,
+              std::string detector) throw(PythonException);
+/**
+ * Exposed to Python
+ * A compressor with infinite ratio, no knee and no attack on the peaks. The
+ * lookahead must be positive; the output then never exceeds the ceiling.
+ * @brief Limits the selection to ceilingDB dBFS.
+ */
+void limit(BufferSingular*, real ceilingDB, real release, real lookahead)
+throw(PythonException);
+/**
+ * Exposed to Python
+ * Channels are weighted according to the channel layout of the buffer for
+ * loudness. See pg::analyze in math/analysis.hpp.
+ * @brief Measures the levels and the loudness of every channel within
+ *  selection.
+ */
+Analysis analyze(BufferSingular*, IntervalIndex selection)
+throw(PythonException);
+/**
+ * Exposed to Python
+ * The channels of each buffer are summed and the whole buffers are compared.
+ * See pg::align in math/correlation.hpp.
+ * @brief Finds the offset, at most maxLag samples either way, at which a
+ *  sample of a occurs in b.
+ */
+Alignment align(BufferSingular const* a, BufferSingular const* b,
+                std::size_t maxLag) throw(PythonException);
+/**
+ * Exposed to Python
+ * Every channel contributes its selection, which should hold only noise.
+ * @brief Measures the spectrum of the noise of the selection for denoise.
+ */
+NoiseProfile noiseProfile(BufferSingular*) throw(PythonException);
+/**
+ * Exposed to Python
+ * See pg::denoise in math/denoise.hpp.
+ * @brief Reduces the noise of the selection by spectral gating.
+ * @param[in] thresholdDB Margin above the profile at which bins pass.
+ * @param[in] reductionDB Attenuation of the other bins.
+ * @param[in] smoothFrames At most MAX_SMOOTH_FRAMES.
+ */
+void denoise(BufferSingular*, NoiseProfile const&, real thresholdDB,
+             real reductionDB, std::size_t smoothBins,
+             std::size_t smoothFrames) throw(PythonException);
+
+/*
+ * The detectors below examine the channels which have a selection, over the
+ * union of their selections, and return intervals of the buffer which can be
+ * passed to BufferSingular::select. See math/detection.hpp.
+ */
+
+/**
+ * Exposed to Python
+ * @brief Finds the runs of at least minDuration seconds where every channel
+ *  stays below thresholdDB dBFS.
+ */
+std::vector<IntervalIndex> detectSilence(BufferSingular*, real thresholdDB,
+                                         real minDuration)
+throw(PythonException);
+/**
+ * Exposed to Python
+ * @brief Splits the selection at its onsets, at least minInterval seconds
+ *  apart. The first interval starts at the first onset.
+ * @param[in] threshold In deviations of the spectral flux above its local
+ *  mean.
+ */
+std::vector<IntervalIndex> detectOnsets(BufferSingular*, real threshold,
+                                        real minInterval)
+throw(PythonException);
+/**
+ * Exposed to Python
+ * The frames start at the beginning of the selection, whose voiced runs are
+ * given as intervals of the buffer.
+ * @brief Tracks the fundamental frequency of the selection.
+ * @param[in] threshold Of the YIN estimator, lower is stricter.
+ */
+Pitch detectPitch(BufferSingular*, real minFrequency, real maxFrequency,
+                  real threshold) throw(PythonException);
 
 }
 
@@ -0,0 +1,116 @@
+#ifndef _POLYGAMMA_SINGULAR_SELECTION_HPP__
+#define _POLYGAMMA_SINGULAR_SELECTION_HPP__
+
+#include <limits>
+#include <vector>
+
+#include "BufferSingular.hpp"
+#include "../math/ThreadPool.hpp"
+
+namespace pg
+{
+
+/**
+ * Samples per chunk of work. 32768 samples fill 256 KB, about the size of a
+ * L2 cache, which keeps a chunk in cache between the passes of a kernel.
+ */
+constexpr std::size_t SELECTION_CHUNK = 1 << 15;
+
+/**
+ * @brief A contiguous part of the selection of one channel.
+ */
+struct selectionChunk
+{
+	std::size_t channel;
+	real* data; // First sample of the chunk
+	std::size_t index; // Index of data within the channel
+	std::size_t length;
+	std::size_t offset; // Position of data within the selection
+	std::size_t total; // Length of the selection
+};
+
+/**
+ * @brief Cuts the selection of every channel into chunks of at most
+ *  SELECTION_CHUNK samples, ordered by channel and then position.
+ * @param[out] changed Union of the selections, if not nullptr.
+ */
+std::vector<selectionChunk> selectionChunks(BufferSingular*,
+                                            IntervalIndex* const changed);
+/**
+ * The chunks run in parallel on ThreadPool::get(), so the kernel must only
+ * touch the samples of its chunk. The buffer is notified once, of the union
+ * of the selections.
+ * @brief Calls kernel(selectionChunk const&) on the selection of every
+ *  channel.
+ */
+template <typename Kernel>
+void processSelection(BufferSingular*, Kernel const& kernel);
+/**
+ * The chunks are mapped in parallel, and the values of each channel are then
+ * folded in order of position on the calling thread, so the result does not
+ * depend on the scheduling.
+ * @brief Reduces the selection of every channel with
+ *  reduce(map(selectionChunk const&), ...).
+ * @return One value per channel, identity for channels without selection.
+ */
+template <typename T, typename Map, typename Reduce>
+std::vector<T> reduceSelection(BufferSingular*, T identity,
+                               Map const& map, Reduce const& reduce);
+
+
+// Implementations
+
+inline std::vector<selectionChunk>
+selectionChunks(BufferSingular* buffer, IntervalIndex* const changed)
+{
+	std::vector<selectionChunk> chunks;
+	if (changed)
+		*changed = IntervalIndex(std::numeric_limits<std::size_t>::max(), 0);
+	for (std::size_t i = 0; i < buffer->nAudioChannels(); ++i)
+	{
+		IntervalIndex const selection = buffer->getSelection(i);
+		if (isEmpty(selection))
+			continue;
+		if (changed)
+			*changed += selection;
+		real* const data = buffer->audioChannel(i)->getData();
+		std::size_t const total = selection.end - selection.begin;
+		for (std::size_t offset = 0; offset < total; offset += SELECTION_CHUNK)
+			chunks.push_back(selectionChunk{i, data + selection.begin + offset,
+			                                selection.begin + offset,
+			                                std::min(SELECTION_CHUNK, total - offset),
+			                                offset, total});
+	}
+	return chunks;
+}
+template <typename Kernel>
+void processSelection(BufferSingular* buffer, Kernel const& kernel)
+{
+	IntervalIndex changed;
+	std::vector<selectionChunk> const chunks = selectionChunks(buffer, &changed);
+	ThreadPool::get().run(chunks.size(), [&](std::size_t i)
+	{
+		kernel(chunks[i]);
+	});
+	if (!isEmpty(changed))
+		buffer->notifyUpdate(Buffer::Update::Data, changed);
+}
+template <typename T, typename Map, typename Reduce>
+std::vector<T> reduceSelection(BufferSingular* buffer, T identity,
+                               Map const& map, Reduce const& reduce)
+{
+	std::vector<selectionChunk> const chunks = selectionChunks(buffer, nullptr);
+	std::vector<T> values(chunks.size(), identity);
+	ThreadPool::get().run(chunks.size(), [&](std::size_t i)
+	{
+		values[i] = map(chunks[i]);
+	});
+	std::vector<T> result(buffer->nAudioChannels(), identity);
+	for (std::size_t i = 0; i < chunks.size(); ++i)
+		result[chunks[i].channel] = reduce(result[chunks[i].channel], values[i]);
+	return result;
+}
+
+} // namespace pg
+
+#endif // !_POLYGAMMA_SINGULAR_SELECTION_HPP__
@@ -239,6 +239,7 @@ void MainWindow::updateUIElements()
 	  "qproperty-colourBG: " + abgrToString(config->uiWaveformBG) + ";"
 	  "qproperty-colourCore: " + abgrToString(config->uiWaveformCore) +";"
 	  "qproperty-colourEdge: " + abgrToString(config->uiWaveformEdge) + ";"
+	  "qproperty-colourPlayhead: " + abgrToString(config->uiWaveformPlayhead) + ";"
 	  "}");
 }
 
@@ -28,6 +28,13 @@ bool EditorSingular::saveAs(QString* const error)
 	return false;
 }
 
+void EditorSingular::update(Buffer::Update update)
+{
+	Editor::update(update);
+	for (std::size_t i = 0; i < buffer->nAudioChannels(); ++i)
+		waveforms[i]->followPlayhead();
+}
+
 void EditorSingular::onUpdateAudioFormat()
 {
 	QLayoutItem* child;
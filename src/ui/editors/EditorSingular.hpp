@@ -20,6 +20,11 @@ public:
 
 	virtual bool saveAs(QString* const error) override;
 	virtual BufferSingular const* getBuffer() const noexcept override;
+	/**
+	 * @brief Also lets the waveforms follow the playhead once playback has
+	 *  started.
+	 */
+	virtual void update(Buffer::Update) override;
 
 
 private Q_SLOTS:
@@ -1,5 +1,6 @@
 #include "Waveform.hpp"
 
+#include <QMouseEvent>
 #include <QPaintEvent>
 #include <QPainter>
 #include <QFile>
@@ -15,7 +16,10 @@ Waveform::Waveform(BufferSingular const* const buffer,
                    std::size_t channelId,
                    QWidget* parent): Viewport2(parent),
 	buffer(buffer), channelId(channelId),
-	channel(buffer->audioChannel(channelId))
+	channel(buffer->audioChannel(channelId)),
+	timerPlayhead(new QTimer(this)),
+	wasPlaying(false), scrubbing(false),
+	scrubPosition(0.0), scrubVelocity(0.0)
 {
 	setDragging(true, false);
 	setZoomFac(1.1, 1.0);
@@ -26,6 +30,79 @@ Waveform::Waveform(BufferSingular const* const buffer,
 	setMaximumRange(0, ((long) channel->getSize() - 1) / UI_SAMPLE_DISPLAY_WIDTH,
 	                0, height());
 	maximise();
+
+	timerPlayhead->setInterval(UI_PLAYHEAD_INTERVAL);
+	timerPlayhead->setSingleShot(false);
+	connect(timerPlayhead, &QTimer::timeout, this, &Waveform::onPlayheadTimer);
+	followPlayhead();
+}
+
+void Waveform::followPlayhead() noexcept
+{
+	if ((buffer->playing() || buffer->scrubbing()) && !timerPlayhead->isActive())
+		timerPlayhead->start();
+}
+void Waveform::onPlayheadTimer()
+{
+	bool const playing = buffer->playing() || buffer->scrubbing();
+	// One last repaint is needed to erase the playhead upon stopping
+	if (playing || wasPlaying)
+		update();
+	else
+		timerPlayhead->stop();
+	wasPlaying = playing;
+}
+
+void Waveform::mousePressEvent(QMouseEvent* event)
+{
+	if (event->button() == Qt::RightButton)
+	{
+		scrubPosition = rasterToSample(event->pos().x());
+		scrubVelocity = 0.0;
+		scrubbing = buffer->scrubBegin(scrubPosition);
+		scrubTimer.start();
+		followPlayhead();
+		event->accept();
+		return;
+	}
+	Viewport2::mousePressEvent(event);
+}
+void Waveform::mouseMoveEvent(QMouseEvent* event)
+{
+	if (scrubbing)
+	{
+		real const position = rasterToSample(event->pos().x());
+		qint64 const elapsed = scrubTimer.nsecsElapsed();
+		if (elapsed > 0)
+		{
+			scrubTimer.restart();
+			// Source samples per output sample, smoothed against mouse jitter
+			real const velocity = (position - scrubPosition) * 1e9 /
+			                      (elapsed * (real) buffer->timeBase());
+			scrubVelocity = 0.5 * (scrubVelocity + velocity);
+		}
+		scrubPosition = position;
+		buffer->scrub(scrubPosition, scrubVelocity);
+		event->accept();
+		return;
+	}
+	Viewport2::mouseMoveEvent(event);
+}
+void Waveform::mouseReleaseEvent(QMouseEvent* event)
+{
+	if (scrubbing && event->button() == Qt::RightButton)
+	{
+		buffer->scrubEnd();
+		scrubbing = false;
+		event->accept();
+		return;
+	}
+	Viewport2::mouseReleaseEvent(event);
+}
+real Waveform::rasterToSample(int x) const noexcept
+{
+	real const sample = (real) rasterToAxialX(x) / UI_SAMPLE_DISPLAY_WIDTH;
+	return std::max(0.0, std::min(sample, (real) channel->getSize() - 1));
 }
 
 void Waveform::paintEvent(QPaintEvent* event)
@@ -108,6 +185,16 @@ void Waveform::paintEvent(QPaintEvent* event)
 		int end = axialToRasterX(selection.end);
 		painter.fillRect(QRect(begin, 0, end - begin, height()), Qt::white);
 	}
+
+	// Draw the playhead
+	if (buffer->playing() || buffer->scrubbing())
+	{
+		painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+		painter.setPen(penPlayhead);
+		int x = axialToRasterX(buffer->playhead() * UI_SAMPLE_DISPLAY_WIDTH);
+		if (x >= 0 && x < width())
+			painter.drawLine(x, 0, x, height());
+	}
 }
 
 } // namespace pg
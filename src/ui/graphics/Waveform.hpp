@@ -1,7 +1,9 @@
 #ifndef _POLYGAMMA_UI_GRAPHICS_WAVEFORM_HPP__
 #define _POLYGAMMA_UI_GRAPHICS_WAVEFORM_HPP__
 
+#include <QElapsedTimer>
 #include <QPen>
+#include <QTimer>
 
 #include "Viewport2.hpp"
 #include "../../singular/BufferSingular.hpp"
@@ -15,9 +17,11 @@ class Waveform final: public Viewport2
 
 	Q_PROPERTY(QColor colourCore READ getColourCore WRITE setColourCore)
 	Q_PROPERTY(QColor colourEdge READ getColourEdge WRITE setColourEdge)
+	Q_PROPERTY(QColor colourPlayhead READ getColourPlayhead WRITE setColourPlayhead)
 
 	QPen penCore;
 	QPen penEdge;
+	QPen penPlayhead;
 public:
 	Waveform(BufferSingular const* const buffer, std::size_t channelId,
 	         QWidget* parent = 0);
@@ -26,17 +30,50 @@ public:
 	QColor getColourCore() const noexcept;
 	void setColourEdge(QColor) noexcept;
 	QColor getColourEdge() const noexcept;
+	void setColourPlayhead(QColor) noexcept;
+	QColor getColourPlayhead() const noexcept;
+
+	/**
+	 * @brief Starts repainting the playhead if the buffer is playing. The
+	 *  repaints stop by themselves once it has stopped.
+	 */
+	void followPlayhead() noexcept;
 
 Q_SIGNALS:
 	void cursorMove(std::size_t);
 
 protected:
 	void paintEvent(QPaintEvent*);
+	/*
+	 * Dragging with RMB scrubs. The position and velocity are handed to the
+	 * buffer directly rather than through a script, to keep the latency low.
+	 */
+	virtual void   mousePressEvent(QMouseEvent*) override;
+	virtual void    mouseMoveEvent(QMouseEvent*) override;
+	virtual void mouseReleaseEvent(QMouseEvent*) override;
+
+private Q_SLOTS:
+	/**
+	 * @brief Repaints at display rate while the buffer is playing. The
+	 *  playhead is read directly from the buffer, bypassing the Kernel.
+	 */
+	void onPlayheadTimer();
 
 private:
 	BufferSingular const* const buffer;
 	std::size_t channelId;
 	Vector<real> const* const channel;
+	QTimer* const timerPlayhead;
+	bool wasPlaying;
+
+	/**
+	 * @brief Source sample under the raster x coordinate.
+	 */
+	real rasterToSample(int x) const noexcept;
+	bool scrubbing;
+	real scrubPosition;
+	real scrubVelocity;
+	QElapsedTimer scrubTimer;
 };
 
 
@@ -58,6 +95,14 @@ inline QColor Waveform::getColourEdge() const noexcept
 {
 	return penEdge.color();
 }
+inline void Waveform::setColourPlayhead(QColor colour) noexcept
+{
+	penPlayhead = QPen(colour, 1);
+}
+inline QColor Waveform::getColourPlayhead() const noexcept
+{
+	return penPlayhead.color();
+}
 
 } // namespace pg
 
@@ -35,6 +35,10 @@ QString abgrToString(Configuration::Colour32);
 constexpr int64_t const UI_SAMPLE_DISPLAY_WIDTH = 1;
 
 constexpr int const UI_EVENTLOOP_INTERVAL = 10;
+/**
+ * @brief Interval in milliseconds between repaints of a moving playhead.
+ */
+constexpr int const UI_PLAYHEAD_INTERVAL = 16;
 
 // Implementations
 
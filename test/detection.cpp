@@ -0,0 +1,42 @@
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "../src/math/detection.hpp"
+#include "../src/math/fourier.hpp"
+
+/*
+ * Tracks a sinusoid through short selections, where the hop of the pitch
+ * track is longer than the largest period searched. The last frames then
+ * start past the end of the signal.
+ */
+int main()
+{
+	pg::real const sampleRate = 48000.0;
+	pg::real const frequency = 440.0;
+	int failures = 0;
+	for (std::size_t length: {1, 480, 481, 4802, 48000})
+		for (pg::real minFrequency: {120.0, 200.0, 400.0})
+		{
+			std::vector<pg::real> signal(length);
+			for (std::size_t i = 0; i < length; ++i)
+				signal[i] = 0.5 * std::sin(2 * M_PI * frequency * i / sampleRate);
+			pg::real const* const channels[] = {signal.data()};
+
+			pg::Pitch const pitch = pg::detectPitch(channels, 1, length, sampleRate,
+			                                        minFrequency, 1000.0, 0.15);
+			bool valid = pitch.frequencies.size() ==
+			             pg::dstftFrames(length, pitch.hop);
+			for (auto f: pitch.frequencies)
+				valid = valid && (f == 0.0 || std::abs(f / frequency - 1) < 0.01);
+			for (auto const& run: pitch.voiced)
+				valid = valid && run.begin < run.end && run.end <= length;
+			if (!valid)
+			{
+				std::cerr << "detectPitch failed for length " << length
+				          << " and minFrequency " << minFrequency << std::endl;
+				++failures;
+			}
+		}
+	return failures ? 1 : 0;
+}